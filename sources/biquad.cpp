@@ -1,36 +1,412 @@
 #include "biquad.h"
+#include "biquad_step.h"
+#include "thread_pool.h"
 
-biquad::biquad(double b0, double b1, double b2, double a1, double a2)
-    : m_b0(b0), m_b1(b1), m_b2(b2), m_a1(a1), m_a2(a2), m_xn1(0), m_xn2(0), m_yn1(0), m_yn2(0)
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+template <typename T, typename C>
+basic_biquad<T, C>::basic_biquad(C b0, C b1, C b2, C a1, C a2, biquad_structure structure)
+    : m_b0(b0), m_b1(b1), m_b2(b2), m_a1(a1), m_a2(a2), m_k1(0), m_k2(0), m_v0(0), m_v1(0),
+      m_structure(biquad_structure::direct_form_1), m_s1(0), m_s2(0), m_s3(0), m_s4(0)
+{
+    set_structure(structure);
+}
+
+template <typename T, typename C>
+basic_biquad<T, C>::basic_biquad()
+    : m_b0(0), m_b1(0), m_b2(0), m_a1(0), m_a2(0), m_k1(0), m_k2(0), m_v0(0), m_v1(0),
+      m_structure(biquad_structure::direct_form_1), m_s1(0), m_s2(0), m_s3(0), m_s4(0)
+{
+}
+
+template <typename T, typename C>
+basic_biquad<T, C>::~basic_biquad()
+{
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::set_structure(biquad_structure structure)
+{
+    if (structure == biquad_structure::lattice)
+    {
+        if (!(std::abs(m_a2) < 1))
+        {
+            throw std::invalid_argument("Lattice structure requires |a2| < 1");
+        }
+        update_lattice();
+    }
+    m_structure = structure;
+    reset();
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::update_lattice()
+{
+    // reflection coefficients of the all-pole part: k2 = a2, k1 = a1 / (1 + a2)
+    m_k2 = m_a2;
+    m_k1 = m_a1 / (1 + m_a2);
+    // ladder coefficients, so that sum(v_m * B_m(z)) equals the numerator
+    m_v1 = m_b1 - m_b2 * m_a1;
+    m_v0 = m_b0 - m_b2 * m_a2 - m_v1 * m_k1;
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::set_coefficients(C b0, C b1, C b2, C a1, C a2)
+{
+    if (m_structure == biquad_structure::lattice && !(std::abs(a2) < 1))
+    {
+        throw std::invalid_argument("Lattice structure requires |a2| < 1");
+    }
+    m_b0 = b0;
+    m_b1 = b1;
+    m_b2 = b2;
+    m_a1 = a1;
+    m_a2 = a2;
+    if (m_structure == biquad_structure::lattice)
+    {
+        update_lattice();
+    }
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::set_steady_state(C level)
+{
+    C output = level * get_dc_gain();
+    switch (m_structure)
+    {
+    case biquad_structure::direct_form_1:
+        m_s1 = m_s2 = level;
+        m_s3 = m_s4 = output;
+        break;
+    case biquad_structure::transposed_direct_form_2:
+        // fixed point of s2 = b2 * x - a2 * y and s1 = b1 * x - a1 * y + s2
+        m_s2 = m_b2 * level - m_a2 * output;
+        m_s1 = m_b1 * level - m_a1 * output + m_s2;
+        m_s3 = m_s4 = 0;
+        break;
+    case biquad_structure::lattice:
+        // fixed point of f0 = x - k2 * g1 - k1 * f0 and g1 = k1 * f0 + f0
+        m_s1 = level / ((1 + m_k1) * (1 + m_k2));
+        m_s2 = (1 + m_k1) * m_s1;
+        m_s3 = m_s4 = 0;
+        break;
+    }
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::get_state(C *state) const
+{
+    const C z[4]{m_s1, m_s2, m_s3, m_s4};
+    std::copy(z, z + get_state_size(), state);
+}
+
+template <typename T, typename C>
+std::vector<C> basic_biquad<T, C>::get_state() const
+{
+    std::vector<C> state(get_state_size());
+    get_state(state.data());
+    return state;
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::set_state(const C *state)
+{
+    C z[4]{};
+    std::copy(state, state + get_state_size(), z);
+    m_s1 = z[0];
+    m_s2 = z[1];
+    m_s3 = z[2];
+    m_s4 = z[3];
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::set_state(const std::vector<C> &state)
+{
+    if (state.size() != get_state_size())
+    {
+        throw std::invalid_argument("State size does not match the structure of the biquad");
+    }
+    set_state(state.data());
+}
+
+template <typename T, typename C>
+T basic_biquad<T, C>::process(T sample)
 {
+    T y = 0;
+    process(&sample, &y, 1);
+    return y;
 }
 
-biquad::biquad()
-    : m_b0(0), m_b1(0), m_b2(0), m_a1(0), m_a2(0), m_xn1(0), m_xn2(0), m_yn1(0), m_yn2(0)
+template <typename T, typename C>
+std::vector<T> basic_biquad<T, C>::process(std::vector<T> samples)
 {
+    // samples is our own copy, so we can filter it in-place and hand it back
+    process_inplace(samples.data(), samples.size());
+    return samples;
 }
 
-biquad::~biquad()
+template <typename T, typename C>
+template <biquad_structure S>
+void basic_biquad<T, C>::process_block(const T *in, T *out, std::size_t n)
 {
+    // keep coefficients and delay line in locals, so they stay in registers for the whole block
+    const C c[5]{S == biquad_structure::lattice ? m_k1 : m_b0,
+                 S == biquad_structure::lattice ? m_k2 : m_b1,
+                 S == biquad_structure::lattice ? m_v0 : m_b2,
+                 S == biquad_structure::lattice ? m_v1 : m_a1,
+                 S == biquad_structure::lattice ? m_b2 : m_a2};
+    C z[4]{m_s1, m_s2, m_s3, m_s4};
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        // read before write: in and out may alias
+        out[i] = static_cast<T>(step<S>(c, z, static_cast<C>(in[i])));
+    }
+
+    m_s1 = z[0];
+    m_s2 = z[1];
+    m_s3 = z[2];
+    m_s4 = z[3];
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::process(const T *in, T *out, std::size_t n)
+{
+    switch (m_structure)
+    {
+    case biquad_structure::direct_form_1:
+        process_block<biquad_structure::direct_form_1>(in, out, n);
+        break;
+    case biquad_structure::transposed_direct_form_2:
+        process_block<biquad_structure::transposed_direct_form_2>(in, out, n);
+        break;
+    case biquad_structure::lattice:
+        process_block<biquad_structure::lattice>(in, out, n);
+        break;
+    }
+}
+
+template <typename T, typename C>
+void basic_biquad<T, C>::process_cascade(basic_biquad *sections, std::size_t n_sections, const T *in, T *out, std::size_t n)
+{
+    if (n_sections == 0)
+    {
+        std::copy(in, in + n, out);
+        return;
+    }
+
+    auto structure = [sections](std::size_t s)
+    { return sections[s].m_structure; };
+    auto load = [sections](std::size_t s, C(&c)[5], C(&z)[4])
+    {
+        const basic_biquad &section = sections[s];
+        const bool lattice = section.m_structure == biquad_structure::lattice;
+        c[0] = lattice ? section.m_k1 : section.m_b0;
+        c[1] = lattice ? section.m_k2 : section.m_b1;
+        c[2] = lattice ? section.m_v0 : section.m_b2;
+        c[3] = lattice ? section.m_v1 : section.m_a1;
+        c[4] = lattice ? section.m_b2 : section.m_a2;
+        z[0] = section.m_s1;
+        z[1] = section.m_s2;
+        z[2] = section.m_s3;
+        z[3] = section.m_s4;
+    };
+    auto store = [sections](std::size_t s, const C(&z)[4])
+    {
+        sections[s].m_s1 = z[0];
+        sections[s].m_s2 = z[1];
+        sections[s].m_s3 = z[2];
+        sections[s].m_s4 = z[3];
+    };
+    process_fused_cascade<C>(n_sections, structure, load, store, in, out, n);
+}
+
+template <typename T, typename C>
+std::vector<double> basic_biquad<T, C>::cascade_transition(const basic_biquad *sections, std::size_t n_sections, std::size_t n)
+{
+    // the delay lines of all sections form the state vector of the cascade ([section][s1, s2, s3, s4])
+    const std::size_t dim = 4 * n_sections;
+    std::vector<basic_biquad> cascade(sections, sections + n_sections);
+
+    // column j of the transition matrix A is the state after one step with zero input from the unit state e_j
+    std::vector<double> a(dim * dim);
+    for (std::size_t j = 0; j < dim; j++)
+    {
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            C *z[4]{&cascade[s].m_s1, &cascade[s].m_s2, &cascade[s].m_s3, &cascade[s].m_s4};
+            for (std::size_t w = 0; w < 4; w++)
+            {
+                *z[w] = 4 * s + w == j ? 1 : 0;
+            }
+        }
+
+        // the samples between the sections are rounded to T, so propagate the unit state with C samples
+        C sample = 0;
+        for (basic_biquad &section : cascade)
+        {
+            const C c[5]{section.m_structure == biquad_structure::lattice ? section.m_k1 : section.m_b0,
+                         section.m_structure == biquad_structure::lattice ? section.m_k2 : section.m_b1,
+                         section.m_structure == biquad_structure::lattice ? section.m_v0 : section.m_b2,
+                         section.m_structure == biquad_structure::lattice ? section.m_v1 : section.m_a1,
+                         section.m_structure == biquad_structure::lattice ? section.m_b2 : section.m_a2};
+            C z[4]{section.m_s1, section.m_s2, section.m_s3, section.m_s4};
+            switch (section.m_structure)
+            {
+            case biquad_structure::direct_form_1:
+                sample = step<biquad_structure::direct_form_1>(c, z, sample);
+                break;
+            case biquad_structure::transposed_direct_form_2:
+                sample = step<biquad_structure::transposed_direct_form_2>(c, z, sample);
+                break;
+            case biquad_structure::lattice:
+                sample = step<biquad_structure::lattice>(c, z, sample);
+                break;
+            }
+            for (std::size_t w = 0; w < 4; w++)
+            {
+                a[(4 * (&section - cascade.data()) + w) * dim + j] = z[w];
+            }
+        }
+    }
+
+    // A^n by repeated squaring
+    auto multiply = [dim](const std::vector<double> &x, const std::vector<double> &y)
+    {
+        std::vector<double> product(dim * dim, 0.0);
+        for (std::size_t i = 0; i < dim; i++)
+        {
+            for (std::size_t k = 0; k < dim; k++)
+            {
+                double x_ik = x[i * dim + k];
+                for (std::size_t j = 0; j < dim; j++)
+                {
+                    product[i * dim + j] += x_ik * y[k * dim + j];
+                }
+            }
+        }
+        return product;
+    };
+    std::vector<double> power(dim * dim, 0.0);
+    for (std::size_t i = 0; i < dim; i++)
+    {
+        power[i * dim + i] = 1;
+    }
+    for (; n != 0; n >>= 1)
+    {
+        if (n & 1)
+        {
+            power = multiply(power, a);
+        }
+        a = multiply(a, a);
+    }
+    return power;
 }
 
-double biquad::process(double sample)
+template <typename T, typename C>
+void basic_biquad<T, C>::process_cascade_parallel(basic_biquad *sections, std::size_t n_sections, const T *in, T *out, std::size_t n,
+                                                  thread_pool &pool)
 {
-    // y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
-    double yn = m_b0 * sample + m_b1 * m_xn1 + m_b2 * m_xn2 - m_a1 * m_yn1 - m_a2 * m_yn2;
-    m_xn2 = m_xn1;
-    m_xn1 = sample;
-    m_yn2 = m_yn1;
-    m_yn1 = yn;
-    return yn;
+    const std::size_t n_chunks = std::min(pool.get_threads(), n / PARALLEL_MIN_CHUNK_SIZE);
+    if (n_chunks < 2 || n_sections == 0)
+    {
+        process_cascade(sections, n_sections, in, out, n);
+        return;
+    }
+
+    // all chunks have the same length, the last one takes the remainder
+    const std::size_t chunk_size = n / n_chunks;
+    const std::size_t dim = 4 * n_sections;
+    std::vector<std::vector<basic_biquad>> chunks(n_chunks, std::vector<basic_biquad>(sections, sections + n_sections));
+    for (std::size_t k = 1; k < n_chunks; k++)
+    {
+        for (basic_biquad &section : chunks[k])
+        {
+            section.reset();
+        }
+    }
+
+    // pass 1: the first chunk is final, of the others only the final state is needed (out is not written,
+    // it may alias in)
+    pool.run(n_chunks - 1, [&](std::size_t k)
+             {
+                 const T *src = in + k * chunk_size;
+                 if (k == 0)
+                 {
+                     process_cascade(chunks[k].data(), n_sections, src, out, chunk_size);
+                     return;
+                 }
+                 T scratch[FUSED_TILE_SIZE];
+                 for (std::size_t tile = 0; tile < chunk_size; tile += FUSED_TILE_SIZE)
+                 {
+                     process_cascade(chunks[k].data(), n_sections, src + tile, scratch, std::min(FUSED_TILE_SIZE, chunk_size - tile));
+                 } });
+
+    // pass 2: propagate the start states, start(k + 1) = A^L * start(k) + final zero state response of chunk k
+    std::vector<double> transition(cascade_transition(sections, n_sections, chunk_size));
+    std::vector<double> state(dim);
+    auto load = [dim](const std::vector<basic_biquad> &cascade, std::vector<double> &z)
+    {
+        for (std::size_t s = 0; s < cascade.size(); s++)
+        {
+            z[4 * s] = cascade[s].m_s1;
+            z[4 * s + 1] = cascade[s].m_s2;
+            z[4 * s + 2] = cascade[s].m_s3;
+            z[4 * s + 3] = cascade[s].m_s4;
+        }
+    };
+    load(chunks[0], state);
+    std::vector<double> zero_state(dim);
+    std::vector<double> next(dim);
+    for (std::size_t k = 1; k < n_chunks; k++)
+    {
+        if (k + 1 < n_chunks)
+        {
+            load(chunks[k], zero_state);
+            for (std::size_t i = 0; i < dim; i++)
+            {
+                double sum = zero_state[i];
+                for (std::size_t j = 0; j < dim; j++)
+                {
+                    sum += transition[i * dim + j] * state[j];
+                }
+                next[i] = sum;
+            }
+        }
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            chunks[k][s].m_s1 = static_cast<C>(state[4 * s]);
+            chunks[k][s].m_s2 = static_cast<C>(state[4 * s + 1]);
+            chunks[k][s].m_s3 = static_cast<C>(state[4 * s + 2]);
+            chunks[k][s].m_s4 = static_cast<C>(state[4 * s + 3]);
+        }
+        std::swap(state, next);
+    }
+
+    // pass 3: filter all chunks but the first from their exact start state
+    pool.run(n_chunks - 1, [&](std::size_t i)
+             {
+                 std::size_t k = i + 1;
+                 std::size_t size = k + 1 < n_chunks ? chunk_size : n - k * chunk_size;
+                 process_cascade(chunks[k].data(), n_sections, in + k * chunk_size, out + k * chunk_size, size); });
+
+    std::copy(chunks.back().begin(), chunks.back().end(), sections);
 }
 
-std::vector<double> biquad::process(std::vector<double> samples)
+#ifdef FILTERLIB_HAS_SPAN
+template <typename T, typename C>
+void basic_biquad<T, C>::process(std::span<const T> in, std::span<T> out)
 {
-    std::vector<double> result;
-    for (double sample : samples)
+    if (in.size() != out.size())
     {
-        result.push_back(this->process(sample));
+        throw std::invalid_argument("Input and output must have the same number of samples");
     }
-    return result;
-}
\ No newline at end of file
+    process(in.data(), out.data(), in.size());
+}
+#endif //FILTERLIB_HAS_SPAN
+
+template class basic_biquad<double>;
+template class basic_biquad<float>;
+template class basic_biquad<float, double>;
@@ -3,12 +3,59 @@
 
 #include <vector>
 #include <complex>
+#include <cstddef>
 
-class biquad
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define FILTERLIB_HAS_SPAN
+#endif
+
+class thread_pool;
+template <typename C>
+class sos_coefficients;
+
+/** Realization of the biquad difference equation. */
+enum class biquad_structure
+{
+    direct_form_1,            // four state words x[n-1], x[n-2], y[n-1], y[n-2] (default)
+    transposed_direct_form_2, // two state words, shortest dependency chain
+    lattice                   // two state words, stays stable when reflection coefficients are modulated
+};
+
+/** Second order section (biquad).
+ *
+ * @tparam T sample type (float or double)
+ * @tparam C type of the coefficients and the delay line (float or double, at least as wide as T)
+ *
+ * Explicitly instantiated for <double>, <float> and <float, double>. Samples are of type T between
+ * the sections of a cascade, the arithmetic within a section is done in C.
+ */
+template <typename T, typename C = T>
+class basic_biquad
 {
 private:
-    double m_b0, m_b1, m_b2, m_a1, m_a2;
-    double m_xn1, m_xn2, m_yn1, m_yn2;
+    C m_b0, m_b1, m_b2, m_a1, m_a2;
+    // lattice-ladder coefficients derived from the direct form (ladder coefficient v2 equals b2)
+    C m_k1, m_k2, m_v0, m_v1;
+    biquad_structure m_structure;
+    // delay line, direct form 1: x[n-1], x[n-2], y[n-1], y[n-2]
+    //             transposed direct form 2: s1[n-1], s2[n-1] (m_s3, m_s4 unused)
+    //             lattice: g0[n-1], g1[n-1] (m_s3, m_s4 unused)
+    C m_s1, m_s2, m_s3, m_s4;
+
+    // minimum number of samples per chunk of the parallel cascade (shorter signals are filtered sequentially)
+    static constexpr std::size_t PARALLEL_MIN_CHUNK_SIZE = 1 << 14;
+
+    template <biquad_structure S>
+    void process_block(const T *in, T *out, std::size_t n);
+
+    void update_lattice();
+
+    static std::vector<double> cascade_transition(const basic_biquad *sections, std::size_t n_sections, std::size_t n);
+
+    // packs the realization coefficients of the sections
+    template <typename>
+    friend class sos_coefficients;
 
 public:
     /** Construct second order section (biquad).
@@ -21,8 +68,9 @@ public:
      * @param b2 coefficient for x[n-2]
      * @param a1 coefficient for x[n-1]
      * @param a2 coefficient for x[n-2]
+     * @param structure realization of the difference equation (the lattice requires |a2| < 1)
      */
-    biquad(double b0, double b1, double b2, double a1, double a2);
+    basic_biquad(C b0, C b1, C b2, C a1, C a2, biquad_structure structure = biquad_structure::direct_form_1);
 
     /** Construct second order section (biquad) with all coefficients set to 0.
      *
@@ -30,8 +78,8 @@ public:
      * y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
      *
      */
-    biquad();
-    ~biquad();
+    basic_biquad();
+    ~basic_biquad();
 
     /** Return filter coefficients of second order section (biquad).
      *
@@ -40,21 +88,167 @@ public:
      *
      * @return vector of coefficients (b0, b1, b2, a1, a2)
      */
-    std::vector<double> get_coefficients() { return std::vector<double>{m_b0, m_b1, m_b2, m_a1, m_a2}; }
+    std::vector<C> get_coefficients() const { return std::vector<C>{m_b0, m_b1, m_b2, m_a1, m_a2}; }
+
+    /** Replace the filter coefficients, keeping the structure and the delay line (e.g. to retune a running filter).
+     *
+     * @param b0 coefficient for x[n]
+     * @param b1 coefficient for x[n-1]
+     * @param b2 coefficient for x[n-2]
+     * @param a1 coefficient for y[n-1]
+     * @param a2 coefficient for y[n-2]
+     * throws std::invalid_argument for the lattice structure if |a2| >= 1 (the coefficients are unchanged then)
+     */
+    void set_coefficients(C b0, C b1, C b2, C a1, C a2);
+
+    /** Select the realization of the difference equation. Resets the delay line.
+     *
+     * @param structure realization of the difference equation (the lattice requires |a2| < 1)
+     */
+    void set_structure(biquad_structure structure);
+
+    /** Get the realization of the difference equation.
+     *
+     * @return structure
+     */
+    biquad_structure get_structure() const { return m_structure; }
+
+    /** Return the gain of the biquad for a constant input (H(z) at z = 1).
+     *
+     * @return (b0 + b1 + b2) / (1 + a1 + a2)
+     */
+    C get_dc_gain() const { return (m_b0 + m_b1 + m_b2) / (1 + m_a1 + m_a2); }
+
+    /** Set the delay line to the steady state of a constant input (no transient when this input continues).
+     *
+     * @param level constant input level, the output level is level * get_dc_gain()
+     */
+    void set_steady_state(C level);
+
+    /** Return the number of delay line words used by the structure.
+     *
+     * @return 4 for direct form 1, 2 for transposed direct form 2 and lattice
+     */
+    std::size_t get_state_size() const { return m_structure == biquad_structure::direct_form_1 ? 4 : 2; }
+
+    /** Copy the delay line without allocating memory.
+     *
+     * @param state output buffer (get_state_size() words)
+     */
+    void get_state(C *state) const;
+
+    /** Return the delay line.
+     *
+     * @return state words: x[n-1], x[n-2], y[n-1], y[n-2] (direct form 1), s1, s2 (transposed direct form 2)
+     *         or g0[n-1], g1[n-1] (lattice)
+     */
+    std::vector<C> get_state() const;
+
+    /** Restore the delay line without allocating memory.
+     *
+     * @param state state words (get_state_size() words)
+     */
+    void set_state(const C *state);
+
+    /** Restore the delay line (see get_state).
+     *
+     * @param state state words, throws std::invalid_argument if the size does not match get_state_size()
+     */
+    void set_state(const std::vector<C> &state);
+
+    /** Reset the delay line to zero. */
+    void reset() { m_s1 = m_s2 = m_s3 = m_s4 = 0; }
 
     /** Process a single sample (feed it into the biquad cascade and return output of last biquad).
      *
      * @param sample single signal sample
      * @return processed sample
      */
-    double process(double sample);
+    T process(T sample);
 
     /** Process a multiple sample (feed them into the biquad cascade and return output of last biquad).
      *
      * @param samples signal samples
      * @return processed samples
      */
-    std::vector<double> process(std::vector<double> samples);
+    std::vector<T> process(std::vector<T> samples);
+
+    /** Process a block of samples without allocating memory.
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    void process(const T *in, T *out, std::size_t n);
+
+    /** Process a block of samples in-place without allocating memory.
+     *
+     * @param data samples, overwritten with the processed samples
+     * @param n number of samples
+     */
+    void process_inplace(T *data, std::size_t n) { process(data, data, n); }
+
+    /** Process a block of samples through a cascade of biquads in a single pass.
+     *
+     * The signal is split into tiles that stay in L1 cache. Each tile is pushed through groups of
+     * sections sample by sample, so the state of all sections in a group stays in registers and the
+     * buffer is not streamed through memory once per section. The result is identical to calling
+     * `process` on every section one after another (sections may use different structures).
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param sections first biquad of the cascade
+     * @param n_sections number of biquads in the cascade
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    static void process_cascade(basic_biquad *sections, std::size_t n_sections, const T *in, T *out, std::size_t n);
+
+    /** Process a long block of samples through a cascade of biquads on multiple threads.
+     *
+     * The signal is split into one chunk per thread of the pool and filtered in three passes:
+     * 1. the first chunk is filtered from the state of the cascade, all others (but the last) from zero state,
+     * 2. the cascade is linear, so the state at the start of chunk k + 1 is A^L * (state at the start of chunk k)
+     *    plus the final state of chunk k filtered from zero state (A: state transition matrix of the cascade,
+     *    L: chunk length). These states are propagated sequentially, A^L is computed by repeated squaring,
+     * 3. all chunks but the first are filtered again from their exact start state.
+     * The result matches `process_cascade` up to rounding, the state of the sections afterwards equals the state
+     * after `process_cascade`. Every chunk but the first is filtered twice, so the speedup over `process_cascade`
+     * is about half the number of threads. Signals shorter than two chunks of PARALLEL_MIN_CHUNK_SIZE samples are
+     * filtered by `process_cascade`.
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param sections first biquad of the cascade
+     * @param n_sections number of biquads in the cascade
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     * @param pool threads used for filtering the chunks
+     */
+    static void process_cascade_parallel(basic_biquad *sections, std::size_t n_sections, const T *in, T *out, std::size_t n,
+                                         thread_pool &pool);
+
+#ifdef FILTERLIB_HAS_SPAN
+    /** Process a block of samples without allocating memory (`in` and `out` must have the same size).
+     *
+     * @param in input samples
+     * @param out output samples
+     */
+    void process(std::span<const T> in, std::span<T> out);
+
+    /** Process a block of samples in-place without allocating memory.
+     *
+     * @param data samples, overwritten with the processed samples
+     */
+    void process_inplace(std::span<T> data) { process(data.data(), data.data(), data.size()); }
+#endif //FILTERLIB_HAS_SPAN
 };
 
+// double precision samples, coefficients and state
+using biquad = basic_biquad<double>;
+
 #endif //!__BIQUAD__H__
\ No newline at end of file
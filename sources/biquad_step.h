@@ -0,0 +1,175 @@
+#ifndef __BIQUAD_STEP__H__
+#define __BIQUAD_STEP__H__
+
+// Internal header: difference equations of the biquad structures and the fused cascade kernel
+// (biquad.cpp, sos.cpp).
+
+#include <algorithm>
+#include <cstddef>
+#include "biquad.h"
+
+namespace
+{
+    /** Process one sample with the difference equation of the given structure.
+     *
+     * Shared by the single sample, block and fused cascade paths of basic_biquad and sos_coefficients,
+     * so all of them give bit-identical results.
+     *
+     * @param c direct form coefficients (b0, b1, b2, a1, a2) or lattice coefficients (k1, k2, v0, v1, v2)
+     * @param z delay line
+     * @param x input sample
+     * @return output sample
+     */
+    template <biquad_structure S, typename C>
+    inline C step(const C (&c)[5], C (&z)[4], C x)
+    {
+        if constexpr (S == biquad_structure::direct_form_1)
+        {
+            // y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+            C y = c[0] * x + c[1] * z[0] + c[2] * z[1] - c[3] * z[2] - c[4] * z[3];
+            z[1] = z[0];
+            z[0] = x;
+            z[3] = z[2];
+            z[2] = y;
+            return y;
+        }
+        else if constexpr (S == biquad_structure::transposed_direct_form_2)
+        {
+            // y[n] = b0 * x[n] + s1[n-1]
+            // s1[n] = b1 * x[n] - a1 * y[n] + s2[n-1]
+            // s2[n] = b2 * x[n] - a2 * y[n]
+            C y = c[0] * x + z[0];
+            z[0] = c[1] * x - c[3] * y + z[1];
+            z[1] = c[2] * x - c[4] * y;
+            return y;
+        }
+        else
+        {
+            // all-pole lattice (forward f, backward g) with ladder taps v
+            C f1 = x - c[1] * z[1];
+            C f0 = f1 - c[0] * z[0];
+            C g1 = c[0] * f0 + z[0];
+            C g2 = c[1] * f1 + z[1];
+            z[0] = f0;
+            z[1] = g1;
+            return c[2] * f0 + c[3] * g1 + c[4] * g2;
+        }
+    }
+
+    // number of sections kept in registers by the fused cascade kernel
+    constexpr std::size_t FUSED_SECTIONS = 4;
+    // number of samples per tile of the fused cascade kernel (stays resident in L1 cache)
+    constexpr std::size_t FUSED_TILE_SIZE = 256;
+
+    /** Push samples through N sections of structure S, coefficients and delay lines held in locals.
+     *
+     * @param load called as load(s, c, z) to fill the coefficients c[5] and delay line z[4] of section s
+     * @param store called as store(s, z) to write back the delay line of section s
+     * @param first index of the first section passed to load and store
+     * @param in input samples
+     * @param out output samples, may be in
+     * @param n number of samples
+     */
+    template <biquad_structure S, std::size_t N, typename T, typename C, typename Load, typename Store>
+    inline void process_fused(Load &load, Store &store, std::size_t first, const T *in, T *out, std::size_t n)
+    {
+        // N is a compile time constant, so the loops over the sections are unrolled
+        C c[N][5];
+        C z[N][4]{};
+        for (std::size_t s = 0; s < N; s++)
+        {
+            load(first + s, c[s], z[s]);
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T sample = in[i];
+            for (std::size_t s = 0; s < N; s++)
+            {
+                // round to the sample type between the sections like the per section path
+                sample = static_cast<T>(step<S>(c[s], z[s], static_cast<C>(sample)));
+            }
+            out[i] = sample;
+        }
+
+        for (std::size_t s = 0; s < N; s++)
+        {
+            store(first + s, z[s]);
+        }
+    }
+
+    /** Process a group of 1 to FUSED_SECTIONS sections of structure S with process_fused. */
+    template <biquad_structure S, typename T, typename C, typename Load, typename Store>
+    inline void process_fused_group(Load &load, Store &store, std::size_t first, std::size_t n_sections, const T *in, T *out, std::size_t n)
+    {
+        static_assert(FUSED_SECTIONS == 4, "Adapt the group size dispatch below");
+
+        switch (n_sections)
+        {
+        case 1:
+            process_fused<S, 1, T, C>(load, store, first, in, out, n);
+            break;
+        case 2:
+            process_fused<S, 2, T, C>(load, store, first, in, out, n);
+            break;
+        case 3:
+            process_fused<S, 3, T, C>(load, store, first, in, out, n);
+            break;
+        default:
+            process_fused<S, FUSED_SECTIONS, T, C>(load, store, first, in, out, n);
+            break;
+        }
+    }
+
+    /** Filter with a cascade of sections, tile by tile through groups of sections kept in registers.
+     *
+     * Each tile of FUSED_TILE_SIZE samples is pushed through groups of up to FUSED_SECTIONS consecutive
+     * sections with the same structure, the first group reads from in and the rest works in-place on the
+     * (still cached) output tile. Shared by basic_biquad::process_cascade and sos_coefficients::process.
+     *
+     * @param n_sections number of sections (at least 1)
+     * @param structure called as structure(s) for the structure of section s
+     * @param load called as load(s, c, z) to fill the coefficients c[5] and delay line z[4] of section s
+     * @param store called as store(s, z) to write back the delay line of section s
+     * @param in input samples
+     * @param out output samples, may be in
+     * @param n number of samples
+     */
+    template <typename C, typename T, typename Structure, typename Load, typename Store>
+    inline void process_fused_cascade(std::size_t n_sections, Structure structure, Load load, Store store, const T *in, T *out, std::size_t n)
+    {
+        for (std::size_t tile = 0; tile < n; tile += FUSED_TILE_SIZE)
+        {
+            std::size_t tile_size = std::min(FUSED_TILE_SIZE, n - tile);
+            const T *src = in + tile;
+            T *dst = out + tile;
+
+            for (std::size_t s = 0; s < n_sections;)
+            {
+                biquad_structure group_structure = structure(s);
+                std::size_t group_size = 1;
+                while (group_size < FUSED_SECTIONS && s + group_size < n_sections && structure(s + group_size) == group_structure)
+                {
+                    group_size++;
+                }
+
+                switch (group_structure)
+                {
+                case biquad_structure::direct_form_1:
+                    process_fused_group<biquad_structure::direct_form_1, T, C>(load, store, s, group_size, src, dst, tile_size);
+                    break;
+                case biquad_structure::transposed_direct_form_2:
+                    process_fused_group<biquad_structure::transposed_direct_form_2, T, C>(load, store, s, group_size, src, dst, tile_size);
+                    break;
+                case biquad_structure::lattice:
+                    process_fused_group<biquad_structure::lattice, T, C>(load, store, s, group_size, src, dst, tile_size);
+                    break;
+                }
+                src = dst;
+                s += group_size;
+            }
+        }
+    }
+} // namespace
+
+#endif //!__BIQUAD_STEP__H__
@@ -66,3 +66,158 @@ TEST(biquad_test, process)
         EXPECT_NEAR(51.0, result[4], EPSILON);
     }
 }
+
+TEST(biquad_test, process_block)
+{
+    double b0{4.0};
+    double b1{3.0};
+    double b2{2.0};
+    double a1{0.0};
+    double a2{-1.0};
+    const double EPSILON = 1.0e-4;
+    {
+        biquad biquad(b0, b1, b2, a1, a2);
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        std::vector<double> result(signal.size());
+
+        // split into two blocks to check that the delay line is carried over
+        biquad.process(signal.data(), result.data(), 2);
+        biquad.process(signal.data() + 2, result.data() + 2, 3);
+
+        EXPECT_NEAR(4.0, result[0], EPSILON);
+        EXPECT_NEAR(15.0, result[1], EPSILON);
+        EXPECT_NEAR(23.0, result[2], EPSILON);
+        EXPECT_NEAR(43.0, result[3], EPSILON);
+        EXPECT_NEAR(51.0, result[4], EPSILON);
+    }
+
+    {
+        biquad biquad(b0, b1, b2, a1, a2);
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        biquad.process_inplace(signal.data(), signal.size());
+
+        EXPECT_NEAR(4.0, signal[0], EPSILON);
+        EXPECT_NEAR(15.0, signal[1], EPSILON);
+        EXPECT_NEAR(23.0, signal[2], EPSILON);
+        EXPECT_NEAR(43.0, signal[3], EPSILON);
+        EXPECT_NEAR(51.0, signal[4], EPSILON);
+    }
+
+#ifdef FILTERLIB_HAS_SPAN
+    {
+        biquad biquad(b0, b1, b2, a1, a2);
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        std::vector<double> result(signal.size());
+        biquad.process(std::span<const double>(signal), std::span<double>(result));
+
+        EXPECT_NEAR(4.0, result[0], EPSILON);
+        EXPECT_NEAR(51.0, result[4], EPSILON);
+        EXPECT_THROW(biquad.process(std::span<const double>(signal), std::span<double>(result).first(2)), std::invalid_argument);
+    }
+#endif //FILTERLIB_HAS_SPAN
+}
+
+TEST(biquad_test, structure)
+{
+    const double EPSILON = 1.0e-10;
+
+    // all structures realize the same difference equation
+    double b0{0.4};
+    double b1{0.3};
+    double b2{-0.2};
+    double a1{-0.5};
+    double a2{0.25};
+    std::vector<double> signal{1, 3, 2, 4, 3, 0, 0, -1, 5, 2};
+
+    biquad reference(b0, b1, b2, a1, a2);
+    std::vector<double> expected(reference.process(signal));
+    for (biquad_structure structure : {biquad_structure::transposed_direct_form_2, biquad_structure::lattice})
+    {
+        biquad biquad(b0, b1, b2, a1, a2, structure);
+        EXPECT_EQ(structure, biquad.get_structure());
+
+        std::vector<double> result(biquad.process(signal));
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], result[i], EPSILON);
+        }
+    }
+
+    // transposed direct form 2 of the process test filter
+    {
+        biquad biquad(4.0, 3.0, 2.0, 0.0, -1.0, biquad_structure::transposed_direct_form_2);
+        std::vector<double> result(biquad.process(std::vector<double>{1, 3, 2, 4, 3}));
+        EXPECT_NEAR(4.0, result[0], EPSILON);
+        EXPECT_NEAR(15.0, result[1], EPSILON);
+        EXPECT_NEAR(23.0, result[2], EPSILON);
+        EXPECT_NEAR(43.0, result[3], EPSILON);
+        EXPECT_NEAR(51.0, result[4], EPSILON);
+    }
+
+    // the lattice is only defined for |a2| < 1
+    EXPECT_THROW(biquad(4.0, 3.0, 2.0, 0.0, -1.0, biquad_structure::lattice), std::invalid_argument);
+}
+
+TEST(biquad_test, state)
+{
+    std::vector<double> signal{1, 3, 2, 4, 3, 0, 0, -1, 5, 2};
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        biquad reference(0.4, 0.3, -0.2, -0.5, 0.25, structure);
+        std::vector<double> expected(reference.process(signal));
+
+        // continue from a snapshot taken in the middle of the signal
+        biquad first(0.4, 0.3, -0.2, -0.5, 0.25, structure);
+        first.process(std::vector<double>(signal.begin(), signal.begin() + 5));
+        std::vector<double> state(first.get_state());
+        EXPECT_EQ(structure == biquad_structure::direct_form_1 ? 4u : 2u, state.size());
+        EXPECT_EQ(state.size(), first.get_state_size());
+
+        biquad second(0.4, 0.3, -0.2, -0.5, 0.25, structure);
+        second.set_state(state);
+        std::vector<double> result(second.process(std::vector<double>(signal.begin() + 5, signal.end())));
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            EXPECT_DOUBLE_EQ(expected[i + 5], result[i]);
+        }
+
+        // reset returns to the initial zero state
+        second.reset();
+        EXPECT_EQ(std::vector<double>(state.size(), 0.0), second.get_state());
+        EXPECT_DOUBLE_EQ(expected[0], second.process(signal[0]));
+
+        EXPECT_THROW(second.set_state(std::vector<double>(3, 0.0)), std::invalid_argument);
+    }
+}
+
+TEST(biquad_test, set_coefficients)
+{
+    std::vector<double> signal{1.0, -0.5, 0.25, 0.8, -1.0, 0.3, 0.0, 0.6};
+
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        // the new coefficients continue from the delay line of the old ones
+        biquad retuned(0.4, 0.3, -0.2, -0.5, 0.25, structure);
+        retuned.process(std::vector<double>(signal.begin(), signal.begin() + 4));
+        std::vector<double> state(retuned.get_state());
+        retuned.set_coefficients(0.2, 0.4, 0.2, -0.6, 0.3);
+        EXPECT_EQ(structure, retuned.get_structure());
+        EXPECT_EQ(state, retuned.get_state());
+        EXPECT_EQ((std::vector<double>{0.2, 0.4, 0.2, -0.6, 0.3}), retuned.get_coefficients());
+
+        biquad expected(0.2, 0.4, 0.2, -0.6, 0.3, structure);
+        expected.set_state(state);
+        for (size_t i = 4; i < signal.size(); i++)
+        {
+            EXPECT_DOUBLE_EQ(expected.process(signal[i]), retuned.process(signal[i]));
+        }
+    }
+
+    biquad lattice(0.4, 0.3, -0.2, -0.5, 0.25, biquad_structure::lattice);
+    EXPECT_THROW(lattice.set_coefficients(0.2, 0.4, 0.2, -0.6, 1.0), std::invalid_argument);
+    EXPECT_EQ((std::vector<double>{0.4, 0.3, -0.2, -0.5, 0.25}), lattice.get_coefficients());
+}
@@ -1,111 +1,544 @@
 #include "butterworth.h"
 #include "utils.h"
+#include "static_design.h"
 #include <complex>
 #include <algorithm>
 #include <exception>
+#include <stdexcept>
 #include <numeric>    // std::accumulate
 #include <functional> // std::multiplies
 #include <assert.h>
 #include <limits>
+#include <string>
+#include <cstring>
 
-butterworth::butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency)
-    : m_filter_order{filter_order}, m_freq{freq}, m_filter_type(filter_type), m_sampling_frequency(sampling_frequency), m_sections{coefficients(filter_order, freq, filter_type, sampling_frequency)}
+template <typename T, typename C>
+basic_butterworth<T, C>::basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                                           biquad_structure structure)
+    : basic_butterworth(filter_order, freq, filter_type, sampling_frequency, filter_design::butter(filter_order, freq, filter_type, sampling_frequency), structure)
 {
 }
 
-butterworth::~butterworth()
+template <typename T, typename C>
+basic_butterworth<T, C>::basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                                           filter_design::design_cache &cache, biquad_structure structure)
+    : basic_butterworth(filter_order, freq, filter_type, sampling_frequency, *cache.get(filter_order, freq, filter_type, sampling_frequency), structure)
 {
 }
 
-double butterworth::process(double sample)
+template <typename T, typename C>
+basic_butterworth<T, C>::basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                                           const std::vector<biquad> &design, biquad_structure structure)
+    : m_filter_order{filter_order}, m_freq{freq}, m_filter_type(filter_type), m_sampling_frequency(sampling_frequency), m_sections{coefficients(design)}, m_structure(biquad_structure::direct_form_1)
 {
-    double result = sample;
+    set_structure(structure);
+}
+
+template <typename T, typename C>
+basic_butterworth<T, C>::~basic_butterworth()
+{
+}
 
-    for (biquad &biquad : m_sections)
+template <typename T, typename C>
+void basic_butterworth<T, C>::set_structure(biquad_structure structure)
+{
+    for (basic_biquad<T, C> &biquad : m_sections)
     {
-        result = biquad.process(result);
+        biquad.set_structure(structure);
+    }
+    m_structure = structure;
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::set_steady_state(std::vector<basic_biquad<T, C>> &sections, C level)
+{
+    // the input level of a section is the output level of its predecessor
+    for (basic_biquad<T, C> &section : sections)
+    {
+        section.set_steady_state(level);
+        level *= section.get_dc_gain();
     }
-    return (result);
 }
 
-std::vector<double> butterworth::process(std::vector<double> samples)
+template <typename T, typename C>
+std::vector<std::vector<C>> basic_butterworth<T, C>::steady_state_initial_conditions()
 {
-    std::vector<double> result(samples);
+    std::vector<std::vector<C>> zi;
+    C level = 1;
+    for (basic_biquad<T, C> &section : m_sections)
+    {
+        // fixed point of the transposed direct form 2 (see basic_biquad::set_steady_state)
+        std::vector<C> c(section.get_coefficients());
+        C output = level * section.get_dc_gain();
+        C s2 = c[2] * level - c[4] * output;
+        C s1 = c[1] * level - c[3] * output + s2;
+        zi.push_back(std::vector<C>{s1, s2});
+        level = output;
+    }
+    return zi;
+}
 
-    for (biquad &biquad : m_sections)
+template <typename T, typename C>
+void basic_butterworth<T, C>::prime(T level)
+{
+    set_steady_state(m_sections, static_cast<C>(level));
+    m_prime_on_next_sample = false;
+}
+
+template <typename T, typename C>
+std::size_t basic_butterworth<T, C>::get_state_size() const
+{
+    std::size_t size = 0;
+    for (const basic_biquad<T, C> &section : m_sections)
     {
-        result = biquad.process(result);
+        size += section.get_state_size();
+    }
+    return size;
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::get_state(C *state) const
+{
+    for (const basic_biquad<T, C> &section : m_sections)
+    {
+        section.get_state(state);
+        state += section.get_state_size();
+    }
+}
+
+template <typename T, typename C>
+std::vector<C> basic_butterworth<T, C>::get_state() const
+{
+    std::vector<C> state(get_state_size());
+    get_state(state.data());
+    return state;
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::set_state(const C *state)
+{
+    for (basic_biquad<T, C> &section : m_sections)
+    {
+        section.set_state(state);
+        state += section.get_state_size();
+    }
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::set_state(const std::vector<C> &state)
+{
+    if (state.size() != get_state_size())
+    {
+        throw std::invalid_argument("State size does not match the sections of the filter");
+    }
+    set_state(state.data());
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::reset()
+{
+    for (basic_biquad<T, C> &section : m_sections)
+    {
+        section.reset();
     }
-    return (result);
 }
 
-std::vector<biquad> butterworth::coefficients(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency)
+namespace
 {
-    std::vector<double> Wn;
+    // lattice parameters (k1, k2, v0, v1, v2) of direct form coefficients (b0, b1, b2, a1, a2), see basic_biquad
+    std::array<double, 5> to_lattice(const std::array<double, 5> &c)
+    {
+        double k1 = c[3] / (1 + c[4]);
+        double v1 = c[1] - c[2] * c[3];
+        return {k1, c[4], c[0] - c[2] * c[4] - v1 * k1, v1, c[2]};
+    }
+
+    std::array<double, 5> from_lattice(const std::array<double, 5> &l)
+    {
+        double a1 = l[0] * (1 + l[1]);
+        return {l[2] + l[4] * l[1] + l[3] * l[0], l[3] + l[4] * a1, l[4], a1, l[1]};
+    }
+
+    const std::uint8_t STATE_MAGIC[4]{'F', 'L', 'S', 'T'};
+    const std::uint8_t STATE_VERSION = 1;
+    // magic, version, structure, sizeof(C), reserved, number of sections
+    const std::size_t STATE_HEADER_SIZE = 8 + sizeof(std::uint32_t);
+} // namespace
+
+template <typename T, typename C>
+std::size_t basic_butterworth<T, C>::get_serialized_state_size() const
+{
+    return STATE_HEADER_SIZE + get_state_size() * sizeof(C);
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::serialize_state(std::uint8_t *buffer) const
+{
+    std::memcpy(buffer, STATE_MAGIC, 4);
+    buffer[4] = STATE_VERSION;
+    buffer[5] = static_cast<std::uint8_t>(m_structure);
+    buffer[6] = sizeof(C);
+    buffer[7] = 0;
+    std::uint32_t n_sections = static_cast<std::uint32_t>(m_sections.size());
+    std::memcpy(buffer + 8, &n_sections, sizeof(n_sections));
+
+    std::uint8_t *data = buffer + STATE_HEADER_SIZE;
+    for (const basic_biquad<T, C> &section : m_sections)
+    {
+        C state[4];
+        section.get_state(state);
+        std::memcpy(data, state, section.get_state_size() * sizeof(C));
+        data += section.get_state_size() * sizeof(C);
+    }
+}
+
+template <typename T, typename C>
+std::vector<std::uint8_t> basic_butterworth<T, C>::serialize_state() const
+{
+    std::vector<std::uint8_t> buffer(get_serialized_state_size());
+    serialize_state(buffer.data());
+    return buffer;
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::deserialize_state(const std::uint8_t *buffer, std::size_t size)
+{
+    if (size < STATE_HEADER_SIZE || std::memcmp(buffer, STATE_MAGIC, 4) != 0 || buffer[4] != STATE_VERSION)
+    {
+        throw std::invalid_argument("Not a serialized filter state");
+    }
+    std::uint32_t n_sections;
+    std::memcpy(&n_sections, buffer + 8, sizeof(n_sections));
+    if (buffer[5] != static_cast<std::uint8_t>(m_structure) || buffer[6] != sizeof(C) ||
+        n_sections != m_sections.size() || size != get_serialized_state_size())
+    {
+        throw std::invalid_argument("Serialized state does not match the structure, coefficient type or sections of the filter");
+    }
+
+    const std::uint8_t *data = buffer + STATE_HEADER_SIZE;
+    for (basic_biquad<T, C> &section : m_sections)
+    {
+        C state[4];
+        std::memcpy(state, data, section.get_state_size() * sizeof(C));
+        section.set_state(state);
+        data += section.get_state_size() * sizeof(C);
+    }
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::init_retune()
+{
+    // double precision design for the current frequencies, the sections only hold it rounded to C
+    m_design.resize(m_sections.size());
+    if (m_filter_order > RETUNE_MAX_ORDER)
+    {
+        std::vector<biquad> design(filter_design::butter(m_filter_order, m_freq, m_filter_type, m_sampling_frequency));
+        for (std::size_t s = 0; s < design.size(); s++)
+        {
+            std::vector<double> c(design[s].get_coefficients());
+            m_design[s] = {c[0], c[1], c[2], c[3], c[4]};
+        }
+    }
+    else
+    {
+        static_design::butter<RETUNE_MAX_ORDER>(m_filter_order, m_freq.data(), m_filter_type, m_sampling_frequency, m_design.data());
+        m_root_indices.resize(m_sections.size());
+    }
+    m_ramp_start.resize(m_sections.size());
+    m_ramp_target.resize(m_sections.size());
+}
 
+template <typename T, typename C>
+void basic_butterworth<T, C>::retune(const std::vector<double> &freq, std::size_t ramp, std::size_t interval)
+{
+    bool band = m_filter_type == filter_design::filter_type::bandpass || m_filter_type == filter_design::filter_type::bandstop;
+    if (freq.size() != (band ? 2u : 1u))
+    {
+        throw std::invalid_argument("Lowpass and highpass filters take one, bandpass and bandstop filters two critical frequencies");
+    }
     for (double f : freq)
     {
-        Wn.push_back(2 * f / sampling_frequency);
-        if (Wn.back() <= 0 || Wn.back() >= 1)
+        if (!(f > 0 && 2 * f < m_sampling_frequency))
         {
             throw std::invalid_argument("Digital filter critical frequencies in freq must be 0 < f < fs/2");
         }
     }
+    if (interval == 0)
+    {
+        throw std::invalid_argument("Interval of the coefficient updates must be greater than 0");
+    }
+
+    if (m_design.empty())
+    {
+        init_retune();
+    }
+
+    // start of a ramp: the coefficients currently in the sections
+    for (std::size_t s = 0; s < m_design.size(); s++)
+    {
+        std::array<double, 5> target(to_lattice(m_design[s]));
+        for (std::size_t i = 0; i < 5; i++)
+        {
+            m_ramp_start[s][i] = m_ramp_position < m_ramp_length
+                                     ? m_ramp_start[s][i] + m_ramp_fraction * (m_ramp_target[s][i] - m_ramp_start[s][i])
+                                     : target[i];
+        }
+    }
+
+    if (m_filter_order > RETUNE_MAX_ORDER)
+    {
+        std::vector<biquad> design(filter_design::butter(m_filter_order, freq, m_filter_type, m_sampling_frequency));
+        for (std::size_t s = 0; s < design.size(); s++)
+        {
+            std::vector<double> c(design[s].get_coefficients());
+            m_design[s] = {c[0], c[1], c[2], c[3], c[4]};
+        }
+    }
+    else
+    {
+        if (!m_has_root_indices)
+        {
+            m_has_root_indices = static_design::pair_roots<RETUNE_MAX_ORDER>(m_filter_order, m_freq.data(), m_filter_type, m_sampling_frequency,
+                                                                             m_design.data(), m_design.size(), m_root_indices.data());
+        }
+        if (m_has_root_indices)
+        {
+            static_design::retune<RETUNE_MAX_ORDER>(m_filter_order, freq.data(), m_filter_type, m_sampling_frequency, m_root_indices.data(),
+                                                    m_design.data(), m_design.size());
+        }
+        else
+        {
+            static_design::butter<RETUNE_MAX_ORDER>(m_filter_order, freq.data(), m_filter_type, m_sampling_frequency, m_design.data());
+        }
+    }
+    m_freq = freq;
+
+    for (std::size_t s = 0; s < m_design.size(); s++)
+    {
+        m_ramp_target[s] = to_lattice(m_design[s]);
+    }
+    m_ramp_length = ramp;
+    m_ramp_position = 0;
+    m_ramp_interval = interval;
+    m_ramp_fraction = 0;
+    if (ramp == 0)
+    {
+        set_ramp_fraction(1);
+    }
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::set_ramp_fraction(double fraction)
+{
+    m_ramp_fraction = fraction;
+    for (std::size_t s = 0; s < m_sections.size(); s++)
+    {
+        std::array<double, 5> c(m_design[s]);
+        if (fraction < 1)
+        {
+            // interpolate the lattice parameters, convex combinations of |k| < 1 stay stable
+            std::array<double, 5> l;
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                l[i] = m_ramp_start[s][i] + fraction * (m_ramp_target[s][i] - m_ramp_start[s][i]);
+            }
+            c = from_lattice(l);
+        }
+        m_sections[s].set_coefficients(static_cast<C>(c[0]), static_cast<C>(c[1]), static_cast<C>(c[2]),
+                                       static_cast<C>(c[3]), static_cast<C>(c[4]));
+    }
+}
+
+template <typename T, typename C>
+T basic_butterworth<T, C>::process(T sample)
+{
+    if (m_ramp_position < m_ramp_length)
+    {
+        T result;
+        process(&sample, &result, 1);
+        return result;
+    }
+    if (m_prime_on_next_sample)
+    {
+        prime(sample);
+    }
+    T result = sample;
+
+    for (basic_biquad<T, C> &biquad : m_sections)
+    {
+        result = biquad.process(result);
+    }
+    return (result);
+}
+
+template <typename T, typename C>
+std::vector<T> basic_butterworth<T, C>::process(std::vector<T> samples)
+{
+    // samples is our own copy, so we can filter it in-place and hand it back
+    process_inplace(samples.data(), samples.size());
+    return (samples);
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::process(const T *in, T *out, std::size_t n)
+{
+    if (m_prime_on_next_sample && n != 0)
+    {
+        prime(in[0]);
+    }
+
+    // retune ramp: filter segments of up to m_ramp_interval samples with interpolated coefficients
+    while (m_ramp_position < m_ramp_length && n != 0)
+    {
+        std::size_t segment_end = std::min((m_ramp_position / m_ramp_interval + 1) * m_ramp_interval, m_ramp_length);
+        std::size_t length = std::min(n, segment_end - m_ramp_position);
+        set_ramp_fraction(static_cast<double>(segment_end) / static_cast<double>(m_ramp_length));
+        process_cascade(in, out, length);
+        m_ramp_position += length;
+        in += length;
+        out += length;
+        n -= length;
+    }
+    process_cascade(in, out, n);
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::process_cascade(const T *in, T *out, std::size_t n)
+{
+    if (m_batch_mode == batch_mode::fused)
+    {
+        basic_biquad<T, C>::process_cascade(m_sections.data(), m_sections.size(), in, out, n);
+        return;
+    }
 
-    // Get analog lowpass prototype
-    filter_design::zpk zpk(filter_design::analog_lowpass(filter_order));
+    if (m_sections.empty())
+    {
+        std::copy(in, in + n, out);
+        return;
+    }
 
-    // Pre-warp frequencies for digital filter design
-    double fs = 2.0;
-    std::vector<double> warped;
-    for (double w : Wn)
+    // first section reads from in, all following sections work in-place on out
+    m_sections.front().process(in, out, n);
+    for (auto it = m_sections.begin() + 1; it != m_sections.end(); it++)
     {
-        warped.push_back(2 * fs * tan(PI * w / fs));
+        it->process_inplace(out, n);
     }
-    if (warped.size() != 1 &&
-        (filter_type == filter_design::filter_type::lowpass ||
-         filter_type == filter_design::filter_type::highpass))
+}
+
+template <typename T, typename C>
+void basic_butterworth<T, C>::process_parallel(const T *in, T *out, std::size_t n, thread_pool &pool)
+{
+    if (m_ramp_position < m_ramp_length)
     {
-        throw std::invalid_argument("Must specify a single critical frequency for lowpass or highpass filter");
+        // time variant while the coefficients change
+        process(in, out, n);
+        return;
     }
-    if (warped.size() != 2 &&
-        (filter_type == filter_design::filter_type::bandpass ||
-         filter_type == filter_design::filter_type::bandstop))
+    if (m_prime_on_next_sample && n != 0)
     {
-        throw std::invalid_argument("Must specify two critical frequencies for bandpass or bandstop filter");
+        prime(in[0]);
     }
+    basic_biquad<T, C>::process_cascade_parallel(m_sections.data(), m_sections.size(), in, out, n, pool);
+}
+
+template <typename T, typename C>
+std::vector<T> basic_butterworth<T, C>::process_parallel(std::vector<T> samples, thread_pool &pool)
+{
+    process_parallel(samples.data(), samples.data(), samples.size(), pool);
+    return (samples);
+}
 
-    // transform to lowpass, bandpass, highpass, or bandstop
-    switch (filter_type)
+template <typename T, typename C>
+void basic_butterworth<T, C>::filtfilt(const T *in, T *out, std::size_t n)
+{
+    // number of samples of the odd extension at each end (3 * ntaps like scipy, first order sections
+    // reduce the number of taps)
+    std::size_t n_first_order_b = 0;
+    std::size_t n_first_order_a = 0;
+    for (basic_biquad<T, C> &section : m_sections)
     {
-    case filter_design::filter_type::lowpass:
+        std::vector<C> c(section.get_coefficients());
+        n_first_order_b += c[2] == 0 ? 1 : 0;
+        n_first_order_a += c[4] == 0 ? 1 : 0;
+    }
+    const std::size_t padlen = 3 * (2 * m_sections.size() + 1 - std::min(n_first_order_b, n_first_order_a));
+    if (n <= padlen)
     {
-        zpk = lp2lp(zpk, warped.at(0));
-        break;
+        throw std::invalid_argument("The length of the input must be greater than padlen = " + std::to_string(padlen));
     }
-    case filter_design::filter_type::highpass:
+
+    // the state of the filter stays untouched, both passes work on a copy of the cascade
+    std::vector<basic_biquad<T, C>> sections(m_sections);
+    const std::size_t TILE_SIZE = 256;
+    T tile[TILE_SIZE];
+
+    // the right extension 2 * x[n-1] - x[n-2-i] is read before out (which may alias in) is written
+    std::vector<T> right(padlen);
+    for (std::size_t i = 0; i < padlen; i++)
     {
-        zpk = lp2hp(zpk, warped.at(0));
-        break;
+        right[i] = 2 * in[n - 1] - in[n - 2 - i];
     }
-    case filter_design::filter_type::bandpass:
+
+    // forward pass: left extension 2 * x[0] - x[padlen-i] (output not needed), signal, right extension
+    set_steady_state(sections, 2 * in[0] - in[padlen]);
+    for (std::size_t start = 0; start < padlen; start += TILE_SIZE)
     {
-        double passband_center = std::sqrt(warped.at(0) * warped.at(1));
-        double passband_width = std::abs(warped.at(1) - warped.at(0));
-        zpk = lp2bp(zpk, passband_center, passband_width);
-        break;
+        std::size_t size = std::min(TILE_SIZE, padlen - start);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            tile[i] = 2 * in[0] - in[padlen - start - i];
+        }
+        basic_biquad<T, C>::process_cascade(sections.data(), sections.size(), tile, tile, size);
     }
-    case filter_design::filter_type::bandstop:
+    basic_biquad<T, C>::process_cascade(sections.data(), sections.size(), in, out, n);
+    basic_biquad<T, C>::process_cascade(sections.data(), sections.size(), right.data(), right.data(), padlen);
+
+    // backward pass: right extension (output not needed), then the signal in reversed tiles
+    set_steady_state(sections, right.back());
+    std::reverse(right.begin(), right.end());
+    basic_biquad<T, C>::process_cascade(sections.data(), sections.size(), right.data(), right.data(), padlen);
+    for (std::size_t end = n; end > 0;)
     {
-        double stopband_center = std::sqrt(warped.at(0) * warped.at(1));
-        double stopband_width = std::abs(warped.at(1) - warped.at(0));
-        zpk = lp2bs(zpk, stopband_center, stopband_width);
-        break;
+        std::size_t size = std::min(TILE_SIZE, end);
+        end -= size;
+        std::reverse_copy(out + end, out + end + size, tile);
+        basic_biquad<T, C>::process_cascade(sections.data(), sections.size(), tile, tile, size);
+        std::reverse_copy(tile, tile + size, out + end);
     }
-    default:
-        throw std::invalid_argument("Filtertype not implemented!");
+}
+
+template <typename T, typename C>
+std::vector<T> basic_butterworth<T, C>::filtfilt(std::vector<T> samples)
+{
+    filtfilt(samples.data(), samples.data(), samples.size());
+    return (samples);
+}
+
+#ifdef FILTERLIB_HAS_SPAN
+template <typename T, typename C>
+void basic_butterworth<T, C>::process(std::span<const T> in, std::span<T> out)
+{
+    if (in.size() != out.size())
+    {
+        throw std::invalid_argument("Input and output must have the same number of samples");
     }
+    process(in.data(), out.data(), in.size());
+}
+#endif //FILTERLIB_HAS_SPAN
 
-    zpk = bilinear_transform(zpk, fs);
-    return (zpk2sos(zpk));
+template <typename T, typename C>
+std::vector<basic_biquad<T, C>> basic_butterworth<T, C>::coefficients(const std::vector<biquad> &design)
+{
+    // round the double precision design to the coefficient type
+    std::vector<basic_biquad<T, C>> sections;
+    for (const biquad &section : design)
+    {
+        std::vector<double> c(section.get_coefficients());
+        sections.emplace_back(static_cast<C>(c[0]), static_cast<C>(c[1]), static_cast<C>(c[2]), static_cast<C>(c[3]), static_cast<C>(c[4]));
+    }
+    return (sections);
 }
+
+template class basic_butterworth<double>;
+template class basic_butterworth<float>;
+template class basic_butterworth<float, double>;
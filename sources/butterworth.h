@@ -2,11 +2,33 @@
 #define __BUTTERWORTH__H__
 
 #include <vector>
+#include <array>
 #include <complex>
+#include <cstdint>
 #include "biquad.h"
 #include "filter_design.h"
+#include "design_cache.h"
+#include "sos.h"
+#include <memory>
+#include "thread_pool.h"
 
-class butterworth
+/** Algorithm used to process a block of samples through the biquad cascade. */
+enum class batch_mode
+{
+    fused,      // tiles of the signal are pushed through all sections in one pass (default)
+    per_section // the whole signal is pushed through one section after the other
+};
+
+/** Butterworth filter as cascade of second order sections.
+ *
+ * @tparam T sample type (float or double)
+ * @tparam C type of the coefficients and the state (float or double, at least as wide as T)
+ *
+ * Explicitly instantiated for <double>, <float> and <float, double>. The filter is always designed in
+ * double precision, the coefficients are rounded to C afterwards.
+ */
+template <typename T, typename C = T>
+class basic_butterworth
 {
 
 private:
@@ -15,8 +37,33 @@ private:
     std::vector<double> m_freq;
     filter_design::filter_type m_filter_type;
     double m_sampling_frequency;
-    std::vector<biquad> m_sections;
-    std::vector<biquad> coefficients(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency);
+    std::vector<basic_biquad<T, C>> m_sections;
+    batch_mode m_batch_mode = batch_mode::fused;
+    biquad_structure m_structure;
+    bool m_prime_on_next_sample = false;
+    // double precision coefficients of the design (the target of a running ramp), empty until the first
+    // retune allocates the retune state below
+    std::vector<std::array<double, 5>> m_design;
+    // roots (p1, p2, z1, z2) of every section in the unpaired design, paired on the first retune
+    std::vector<std::array<std::size_t, 4>> m_root_indices;
+    bool m_has_root_indices = false;
+    // lattice parameters (k1, k2, v0, v1, v2) per section at the start and the end of the retune ramp
+    std::vector<std::array<double, 5>> m_ramp_start;
+    std::vector<std::array<double, 5>> m_ramp_target;
+    std::size_t m_ramp_length = 0;
+    std::size_t m_ramp_position = 0;
+    std::size_t m_ramp_interval = 1;
+    double m_ramp_fraction = 0; // interpolation weight of the coefficients in the sections
+    // highest order retuned on fixed capacity storage, higher orders allocate
+    static constexpr int RETUNE_MAX_ORDER = 32;
+
+    basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                      const std::vector<biquad> &design, biquad_structure structure);
+    static void set_steady_state(std::vector<basic_biquad<T, C>> &sections, C level);
+    static std::vector<basic_biquad<T, C>> coefficients(const std::vector<biquad> &design);
+    void init_retune();
+    void set_ramp_fraction(double fraction);
+    void process_cascade(const T *in, T *out, std::size_t n);
 
 public:
     /** Butterworth digital filter design.
@@ -31,29 +78,274 @@ public:
      *             (`freq` is thus in half-cycles / sample.)
      * @param filter_type The type of filter.
      * @param sampling_frequency The sampling frequency of the digital system.
+     * @param structure Realization of the second order sections.
      */
-    butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency);
-    ~butterworth();
+    basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                      biquad_structure structure = biquad_structure::direct_form_1);
+
+    /** Butterworth digital filter with the design taken from a cache (see filter_design::design_cache).
+     *
+     * Parameters are the same as for the constructor above. Repeated parameters skip the design and only
+     * copy the cached coefficients.
+     *
+     * @param cache design cache, e.g. filter_design::design_cache::global()
+     */
+    basic_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                      filter_design::design_cache &cache, biquad_structure structure = biquad_structure::direct_form_1);
+    ~basic_butterworth();
 
     /** Get second order sections of filter
      *
      * @return vector of biquads (second order sections)
      */
-    std::vector<biquad> get_sections() { return m_sections; }
+    std::vector<basic_biquad<T, C>> get_sections() { return m_sections; }
+
+    /** Get the coefficients of the cascade as shareable, immutable object (in the current structure).
+     *
+     * Many streams with the same design can be filtered with one sos_coefficients object and one
+     * sos_state per stream.
+     *
+     * @return shared coefficients
+     */
+    std::shared_ptr<const sos_coefficients<C>> get_sos_coefficients() const
+    {
+        return std::make_shared<const sos_coefficients<C>>(m_sections, m_structure);
+    }
+
+    /** Select the algorithm used to process blocks of samples.
+     *
+     * @param mode batch mode (fused by default)
+     */
+    void set_batch_mode(batch_mode mode) { m_batch_mode = mode; }
+
+    /** Get the algorithm used to process blocks of samples.
+     *
+     * @return batch mode
+     */
+    batch_mode get_batch_mode() { return m_batch_mode; }
+
+    /** Select the realization of all second order sections. Resets the state of the cascade.
+     *
+     * @param structure realization of the second order sections
+     */
+    void set_structure(biquad_structure structure);
+
+    /** Get the realization of the second order sections.
+     *
+     * @return structure
+     */
+    biquad_structure get_structure() { return m_structure; }
+
+    /** Retune the filter to new critical frequencies (same order, type and sampling frequency), keeping the
+     * state, so a running signal continues without restarting the filter.
+     *
+     * The sections are redesigned without heap allocation and without the zpk2sos pairing, every section keeps
+     * its place in the cascade and follows its poles and zeros to the new frequencies (static_design::retune).
+     * The roots of the sections are paired with the design once (static_design::pair_roots, on the first
+     * retune), after that a retune is one unpaired design and a rebuild of the sections in O(order). Orders
+     * above RETUNE_MAX_ORDER are designed again (allocating). The state of the retune is allocated by the first
+     * call, so filters that are never retuned do not carry it.
+     *
+     * With a ramp, the coefficients move to the new design during the next `ramp` samples of process, linearly
+     * interpolated in the lattice parameters (reflection and ladder coefficients) every `interval` samples.
+     * Every intermediate cascade is stable, the lattice structure also stays stable while its coefficients
+     * change, so use biquad_structure::lattice for fast sweeps. Retuning during a ramp starts a new ramp from
+     * the current coefficients. process_parallel filters sequentially while a ramp is running.
+     *
+     * @param freq new critical frequencies, throws std::invalid_argument if they are invalid
+     * @param ramp number of samples until the new design is reached (0: switch immediately)
+     * @param interval number of samples between coefficient updates during the ramp (1: every sample),
+     *                 throws std::invalid_argument if 0
+     */
+    void retune(const std::vector<double> &freq, std::size_t ramp = 0, std::size_t interval = 1);
+
+    /** Get the critical frequencies of the current design
+     *
+     * @return critical frequencies
+     */
+    const std::vector<double> &get_freq() const { return m_freq; }
+
+    /** Steady state of every section for a unit step input (like scipy.signal.sosfilt_zi).
+     *
+     * The states are given in transposed direct form 2 (as used by scipy), independent of the structure
+     * of the sections. Multiplied by the first sample they are the initial conditions that avoid the
+     * warm-up transient.
+     *
+     * @return s1, s2 per section
+     */
+    std::vector<std::vector<C>> steady_state_initial_conditions();
+
+    /** Set the state of the cascade to the steady state of a constant input, so a signal around this
+     * DC level is filtered without warm-up transient.
+     *
+     * @param level constant input level
+     */
+    void prime(T level);
+
+    /** Prime the cascade with the first sample passed to the next call of process (see prime),
+     * e.g. when a new stream is attached.
+     */
+    void prime_on_next_sample() { m_prime_on_next_sample = true; }
+
+    /** Return the number of state words of the cascade (sum of basic_biquad::get_state_size).
+     *
+     * @return number of state words
+     */
+    std::size_t get_state_size() const;
+
+    /** Copy the state of all sections without allocating memory.
+     *
+     * @param state output buffer (get_state_size() words, section by section)
+     */
+    void get_state(C *state) const;
+
+    /** Return the state of all sections (section by section, see basic_biquad::get_state).
+     *
+     * @return state words
+     */
+    std::vector<C> get_state() const;
+
+    /** Restore the state of all sections without allocating memory.
+     *
+     * @param state state words (get_state_size() words, section by section)
+     */
+    void set_state(const C *state);
+
+    /** Restore the state of all sections (see get_state).
+     *
+     * @param state state words, throws std::invalid_argument if the size does not match get_state_size()
+     */
+    void set_state(const std::vector<C> &state);
+
+    /** Reset the state of all sections to zero. */
+    void reset();
+
+    /** Return the size of the serialized state.
+     *
+     * @return number of bytes
+     */
+    std::size_t get_serialized_state_size() const;
+
+    /** Serialize the state of the cascade without allocating memory.
+     *
+     * Layout: "FLST", format version, structure, sizeof(C), 0 (one byte each), number of sections (uint32),
+     * state words. Numbers are stored in native byte order.
+     *
+     * @param buffer output buffer (get_serialized_state_size() bytes)
+     */
+    void serialize_state(std::uint8_t *buffer) const;
+
+    /** Serialize the state of the cascade (see serialize_state(std::uint8_t *)).
+     *
+     * @return serialized state
+     */
+    std::vector<std::uint8_t> serialize_state() const;
+
+    /** Restore the state of the cascade from a serialized state.
+     *
+     * @param buffer serialized state
+     * @param size size of the serialized state, throws std::invalid_argument if the state was serialized
+     *             by a filter with a different structure, coefficient type or number of sections
+     */
+    void deserialize_state(const std::uint8_t *buffer, std::size_t size);
+
+    /** Restore the state of the cascade from a serialized state (see deserialize_state(const std::uint8_t *, std::size_t)).
+     *
+     * @param buffer serialized state
+     */
+    void deserialize_state(const std::vector<std::uint8_t> &buffer) { deserialize_state(buffer.data(), buffer.size()); }
 
     /** Process a single sample (feed it into the biquad cascade and return output of last biquad)
      *
      * @param sample single signal sample
      * @return processed sample
      */
-    double process(double sample);
+    T process(T sample);
 
     /** Process a multiple sample (feed them into the biquad cascade and return output of last biquad)
      *
      * @param samples signal samples
      * @return processed samples
      */
-    std::vector<double> process(std::vector<double> samples);
+    std::vector<T> process(std::vector<T> samples);
+
+    /** Process a block of samples through the biquad cascade without allocating memory.
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    void process(const T *in, T *out, std::size_t n);
+
+    /** Process a block of samples in-place through the biquad cascade without allocating memory.
+     *
+     * @param data samples, overwritten with the processed samples
+     * @param n number of samples
+     */
+    void process_inplace(T *data, std::size_t n) { process(data, data, n); }
+
+    /** Process a long signal offline on multiple threads (see basic_biquad::process_cascade_parallel).
+     *
+     * The result matches `process` up to rounding and the filter continues with the same state.
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     * @param pool threads used for filtering, the signal is split into one chunk per thread
+     */
+    void process_parallel(const T *in, T *out, std::size_t n, thread_pool &pool);
+
+    /** Process a long signal offline on multiple threads (see basic_biquad::process_cascade_parallel).
+     *
+     * @param samples signal samples
+     * @param pool threads used for filtering, the signal is split into one chunk per thread
+     * @return processed samples
+     */
+    std::vector<T> process_parallel(std::vector<T> samples, thread_pool &pool);
+
+    /** Zero-phase filtering: apply the filter forward and backward (like scipy.signal.sosfiltfilt).
+     *
+     * The signal is extended at both ends by odd reflection of padlen = 3 * (2 * n_sections + 1) samples
+     * (minus the number of first order sections), both passes start from the steady state of their first sample.
+     * The backward pass runs in-place on `out` in reversed tiles, so no reversed copy of the signal is made.
+     * Independent of the state of the filter, which is not changed.
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input samples (more than padlen), throws std::invalid_argument otherwise
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    void filtfilt(const T *in, T *out, std::size_t n);
+
+    /** Zero-phase filtering: apply the filter forward and backward (like scipy.signal.sosfiltfilt).
+     *
+     * @param samples signal samples (more than padlen)
+     * @return filtered samples
+     */
+    std::vector<T> filtfilt(std::vector<T> samples);
+
+#ifdef FILTERLIB_HAS_SPAN
+    /** Process a block of samples through the biquad cascade without allocating memory
+     * (`in` and `out` must have the same size).
+     *
+     * @param in input samples
+     * @param out output samples
+     */
+    void process(std::span<const T> in, std::span<T> out);
+
+    /** Process a block of samples in-place through the biquad cascade without allocating memory.
+     *
+     * @param data samples, overwritten with the processed samples
+     */
+    void process_inplace(std::span<T> data) { process(data.data(), data.data(), data.size()); }
+#endif //FILTERLIB_HAS_SPAN
 };
 
+// double precision samples, coefficients and state
+using butterworth = basic_butterworth<double>;
+
 #endif //!__BUTTERWORTH__H__
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 #include "biquad.h"
 #include "filter_design.h"
@@ -412,3 +414,502 @@ TEST(butterworth_test, process)
         EXPECT_NEAR(2.8257, result[4], EPSILON);
     }
 }
+
+TEST(butterworth_test, process_block)
+{
+    //******************************************************************************
+    // scipy signal generated with the following code:
+    //
+    // sos = signal.butter(4, [15,20], 'bs', fs=50, output='sos')
+    // y_filt = signal.sosfilt(sos, np.array([1,3,2,4,3]))
+    //
+    //******************************************************************************
+    int filter_order = 4;
+    std::vector<double> freq{15, 20};
+    double sampling_frequency = 50;
+    const double EPSILON = 1.0e-4;
+    {
+        butterworth butterworth{filter_order, freq, filter_design::filter_type::bandstop, sampling_frequency};
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        std::vector<double> result(signal.size());
+
+        // split into two blocks to check that the state of the cascade is carried over
+        butterworth.process(signal.data(), result.data(), 3);
+        butterworth.process(signal.data() + 3, result.data() + 3, 2);
+
+        EXPECT_NEAR(0.4328, result[0], EPSILON);
+        EXPECT_NEAR(1.7347, result[1], EPSILON);
+        EXPECT_NEAR(2.5811, result[2], EPSILON);
+        EXPECT_NEAR(3.4544, result[3], EPSILON);
+        EXPECT_NEAR(2.8257, result[4], EPSILON);
+    }
+
+    {
+        butterworth butterworth{filter_order, freq, filter_design::filter_type::bandstop, sampling_frequency};
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        butterworth.process_inplace(signal.data(), signal.size());
+
+        EXPECT_NEAR(0.4328, signal[0], EPSILON);
+        EXPECT_NEAR(1.7347, signal[1], EPSILON);
+        EXPECT_NEAR(2.5811, signal[2], EPSILON);
+        EXPECT_NEAR(3.4544, signal[3], EPSILON);
+        EXPECT_NEAR(2.8257, signal[4], EPSILON);
+    }
+}
+
+TEST(butterworth_test, batch_mode)
+{
+    // fused and per section processing must give identical results, also for
+    // cascades that do not fill a full group of sections and signals longer than one tile
+    std::vector<double> signal;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+
+    for (int filter_order : {1, 5, 8, 11})
+    {
+        std::vector<double> freq{10, 20};
+        double sampling_frequency = 50;
+        butterworth fused{filter_order, freq, filter_design::filter_type::bandpass, sampling_frequency};
+        butterworth per_section{filter_order, freq, filter_design::filter_type::bandpass, sampling_frequency};
+        butterworth sample{filter_order, freq, filter_design::filter_type::bandpass, sampling_frequency};
+        // mixed structures within the cascade
+        fused.set_structure(filter_order % 2 ? biquad_structure::lattice : biquad_structure::transposed_direct_form_2);
+        per_section.set_structure(fused.get_structure());
+        sample.set_structure(fused.get_structure());
+        EXPECT_EQ(fused.get_batch_mode(), batch_mode::fused);
+        per_section.set_batch_mode(batch_mode::per_section);
+
+        std::vector<double> result_fused(fused.process(signal));
+        std::vector<double> result_per_section(per_section.process(signal));
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_DOUBLE_EQ(result_fused[i], result_per_section[i]);
+            EXPECT_DOUBLE_EQ(result_fused[i], sample.process(signal[i]));
+        }
+    }
+}
+
+TEST(butterworth_test, structure)
+{
+    //******************************************************************************
+    // scipy signal generated with the following code:
+    //
+    // sos = signal.butter(4, [15,20], 'bs', fs=50, output='sos')
+    // y_filt = signal.sosfilt(sos, np.array([1,3,2,4,3]))
+    //
+    //******************************************************************************
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        int filter_order = 4;
+        std::vector<double> freq{15, 20};
+        double sampling_frequency = 50;
+        butterworth butterworth{filter_order, freq, filter_design::filter_type::bandstop, sampling_frequency, structure};
+        EXPECT_EQ(structure, butterworth.get_structure());
+        std::vector<double> signal{1, 3, 2, 4, 3};
+        std::vector<double> result(butterworth.process(signal));
+
+        const double EPSILON = 1.0e-4;
+        EXPECT_NEAR(0.4328, result[0], EPSILON);
+        EXPECT_NEAR(1.7347, result[1], EPSILON);
+        EXPECT_NEAR(2.5811, result[2], EPSILON);
+        EXPECT_NEAR(3.4544, result[3], EPSILON);
+        EXPECT_NEAR(2.8257, result[4], EPSILON);
+    }
+
+    // all structures agree on a long signal
+    std::vector<double> signal;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+    butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::vector<double> expected(reference.process(signal));
+    for (biquad_structure structure : {biquad_structure::transposed_direct_form_2, biquad_structure::lattice})
+    {
+        butterworth butterworth{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        std::vector<double> result(butterworth.process(signal));
+
+        const double EPSILON = 1.0e-9;
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], result[i], EPSILON);
+        }
+    }
+}
+
+TEST(butterworth_test, sample_type)
+{
+    //******************************************************************************
+    // scipy signal generated with the following code:
+    //
+    // sos = signal.butter(4, [15,20], 'bs', fs=50, output='sos')
+    // y_filt = signal.sosfilt(sos, np.array([1,3,2,4,3]))
+    //
+    //******************************************************************************
+    {
+        basic_butterworth<float> single{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+        basic_butterworth<float, double> mixed{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+        std::vector<float> signal{1, 3, 2, 4, 3};
+        std::vector<float> expected{0.4328f, 1.7347f, 2.5811f, 3.4544f, 2.8257f};
+        std::vector<float> result_single(single.process(signal));
+        std::vector<float> result_mixed(mixed.process(signal));
+
+        const float EPSILON = 1.0e-4f;
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], result_single[i], EPSILON);
+            EXPECT_NEAR(expected[i], result_mixed[i], EPSILON);
+        }
+    }
+
+    // float samples track the double precision cascade on a long signal, the error shrinks
+    // when the arithmetic within the sections is done in double precision
+    std::vector<double> signal;
+    std::vector<float> signal_float;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+        signal_float.push_back(static_cast<float>(signal.back()));
+    }
+    butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::vector<double> expected(reference.process(signal));
+
+    basic_butterworth<float> single{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    basic_butterworth<float, double> mixed{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::vector<float> result_single(single.process(signal_float));
+    std::vector<float> result_mixed(mixed.process(signal_float));
+
+    double error_single = 0;
+    double error_mixed = 0;
+    for (size_t i = 0; i < signal.size(); i++)
+    {
+        error_single = std::max(error_single, std::abs(expected[i] - result_single[i]));
+        error_mixed = std::max(error_mixed, std::abs(expected[i] - result_mixed[i]));
+    }
+    EXPECT_LT(error_single, 1.0e-5);
+    EXPECT_LT(error_mixed, 1.0e-6);
+    EXPECT_LT(error_mixed, error_single);
+}
+
+TEST(butterworth_test, process_parallel)
+{
+    // long enough for several chunks, not a multiple of the number of threads
+    std::vector<double> signal;
+    for (int i = 0; i < 200003; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i) + (i % 7 == 0 ? 1.0 : 0.0));
+    }
+
+    thread_pool pool(4);
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        butterworth butterworth{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+
+        // start from a non-zero state, continue sequentially after the parallel block
+        std::vector<double> head(signal.begin(), signal.begin() + 100);
+        std::vector<double> expected(reference.process(head));
+        butterworth.process(head);
+        std::vector<double> body(signal.begin() + 100, signal.end());
+        std::vector<double> expected_body(reference.process(body));
+        std::vector<double> result(butterworth.process_parallel(body, pool));
+        std::vector<double> expected_tail(reference.process(head));
+        std::vector<double> result_tail(butterworth.process(head));
+
+        const double EPSILON = 1.0e-9;
+        ASSERT_EQ(expected_body.size(), result.size());
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            EXPECT_NEAR(expected_body[i], result[i], EPSILON);
+        }
+        for (size_t i = 0; i < head.size(); i++)
+        {
+            EXPECT_NEAR(expected_tail[i], result_tail[i], EPSILON);
+        }
+    }
+
+    // short signals and in-place processing
+    butterworth reference{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+    butterworth butterworth{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+    std::vector<double> expected(reference.process(signal));
+    std::vector<double> result(signal);
+    butterworth.process_parallel(result.data(), result.data(), 10, pool);
+    butterworth.process_parallel(result.data() + 10, result.data() + 10, result.size() - 10, pool);
+    for (size_t i = 0; i < result.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], result[i], 1.0e-9);
+    }
+}
+
+TEST(butterworth_test, filtfilt)
+{
+    //******************************************************************************
+    // scipy signal generated with the following code:
+    //
+    // x = np.array([1, 3, 2, 4, 3, 5, 4, 2, 1, 0, -1, -3, -2, 0, 1, 2, 4, 3, 2, 1])
+    // sos = signal.butter(4, 10, 'lp', fs=50, output='sos')
+    // y_filt = signal.sosfiltfilt(sos, x)
+    // sos = signal.butter(2, [10, 20], 'bp', fs=50, output='sos')
+    // y_filt = signal.sosfiltfilt(sos, x)
+    //
+    //******************************************************************************
+    const std::vector<double> signal{1, 3, 2, 4, 3, 5, 4, 2, 1, 0, -1, -3, -2, 0, 1, 2, 4, 3, 2, 1};
+    const std::vector<double> expected_lowpass{1.0012, 2.0015, 2.8066, 3.4536, 3.9882, 4.1791, 3.7167,
+                                               2.6112, 1.1711, -0.3082, -1.5706, -2.2241, -1.8922, -0.6079,
+                                               1.1119, 2.5868, 3.3154, 3.1433, 2.2531, 0.9983};
+    const std::vector<double> expected_bandpass{0.0014, 0.6621, -0.2443, -0.1311, -0.3436, 0.3417, 0.5586,
+                                                -0.6393, -0.2663, 0.5134, 0.3270, -0.6223, -0.2941, 0.7401,
+                                                -0.2545, -0.4030, 0.5589, 0.0225, -0.3336, 0.0019};
+
+    const double EPSILON = 1.0e-4;
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        butterworth lowpass{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50, structure};
+        std::vector<double> result(lowpass.filtfilt(signal));
+        ASSERT_EQ(signal.size(), result.size());
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected_lowpass[i], result[i], EPSILON);
+        }
+
+        // in-place, the state of the filter is not changed
+        butterworth bandpass{2, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        result = signal;
+        bandpass.filtfilt(result.data(), result.data(), result.size());
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected_bandpass[i], result[i], EPSILON);
+        }
+        EXPECT_EQ(0.0, bandpass.process(0.0));
+    }
+
+    // the signal must be longer than padlen (3 * (2 * 2 + 1) = 15 samples for two sections)
+    butterworth lowpass{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50};
+    EXPECT_THROW(lowpass.filtfilt(std::vector<double>(15, 1.0)), std::invalid_argument);
+    EXPECT_NO_THROW(lowpass.filtfilt(std::vector<double>(16, 1.0)));
+}
+
+TEST(butterworth_test, steady_state)
+{
+    //******************************************************************************
+    // scipy signal generated with the following code:
+    //
+    // sos = signal.butter(4, 10, 'lp', fs=50, output='sos')
+    // zi = signal.sosfilt_zi(sos)
+    // x = np.array([2, 2.5, 3, 3.5, 4])
+    // y_filt = signal.sosfilt(sos, x, zi=zi * x[0])[0]
+    //
+    //******************************************************************************
+    const double EPSILON = 1.0e-4;
+    butterworth lowpass{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50};
+    std::vector<std::vector<double>> zi(lowpass.steady_state_initial_conditions());
+    ASSERT_EQ(2u, zi.size());
+    EXPECT_NEAR(0.2067, zi[0][0], EPSILON);
+    EXPECT_NEAR(0.0302, zi[0][1], EPSILON);
+    EXPECT_NEAR(0.7467, zi[1][0], EPSILON);
+    EXPECT_NEAR(-0.2130, zi[1][1], EPSILON);
+
+    const std::vector<double> signal{2, 2.5, 3, 3.5, 4};
+    const std::vector<double> expected{2.0000, 2.0233, 2.1580, 2.5037, 3.0361};
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        // prime from the first sample of a block
+        butterworth block{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50, structure};
+        block.prime_on_next_sample();
+        std::vector<double> result(block.process(signal));
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], result[i], EPSILON);
+        }
+
+        // prime from the first sample processed sample by sample, only the first sample primes
+        butterworth sample{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50, structure};
+        sample.prime_on_next_sample();
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_NEAR(expected[i], sample.process(signal[i]), EPSILON);
+        }
+
+        // prime with a DC level: no transient for a constant input
+        butterworth bandstop{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50, structure};
+        butterworth bandpass{4, std::vector<double>{15, 20}, filter_design::filter_type::bandpass, 50, structure};
+        bandstop.prime(3.0);
+        bandpass.prime(3.0);
+        for (int i = 0; i < 10; i++)
+        {
+            EXPECT_NEAR(3.0, bandstop.process(3.0), 1.0e-9);
+            EXPECT_NEAR(0.0, bandpass.process(3.0), 1.0e-9);
+        }
+    }
+}
+
+TEST(butterworth_test, state)
+{
+    std::vector<double> signal;
+    for (int i = 0; i < 500; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+    std::vector<double> head(signal.begin(), signal.begin() + 200);
+    std::vector<double> tail(signal.begin() + 200, signal.end());
+
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        reference.process(head);
+        std::vector<double> expected(reference.process(tail));
+
+        // snapshot and restore on another instance
+        butterworth first{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        first.process(head);
+        std::vector<double> state(first.get_state());
+        EXPECT_EQ((structure == biquad_structure::direct_form_1 ? 4u : 2u) * 8, state.size());
+        butterworth second{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        second.set_state(state);
+        EXPECT_EQ(expected, second.process(tail));
+
+        // serialize and deserialize (migrate a stream)
+        std::vector<std::uint8_t> serialized(first.serialize_state());
+        EXPECT_EQ(first.get_serialized_state_size(), serialized.size());
+        EXPECT_EQ(12 + state.size() * sizeof(double), serialized.size());
+        butterworth third{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        third.deserialize_state(serialized);
+        EXPECT_EQ(expected, third.process(tail));
+
+        // reset returns to the initial zero state
+        third.reset();
+        EXPECT_EQ(std::vector<double>(state.size(), 0.0), third.get_state());
+        butterworth fresh{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        EXPECT_EQ(fresh.process(head), third.process(head));
+
+        EXPECT_THROW(third.set_state(std::vector<double>(3, 0.0)), std::invalid_argument);
+    }
+
+    // serialized states only fit filters with the same structure, coefficient type and sections
+    butterworth filter{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::vector<std::uint8_t> serialized(filter.serialize_state());
+    butterworth lattice{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, biquad_structure::lattice};
+    butterworth lowpass{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50};
+    basic_butterworth<float, float> single{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    EXPECT_THROW(lattice.deserialize_state(serialized), std::invalid_argument);
+    EXPECT_THROW(lowpass.deserialize_state(serialized), std::invalid_argument);
+    EXPECT_THROW(single.deserialize_state(serialized), std::invalid_argument);
+    EXPECT_THROW(filter.deserialize_state(serialized.data(), serialized.size() - 1), std::invalid_argument);
+    serialized[0] = 'X';
+    EXPECT_THROW(filter.deserialize_state(serialized), std::invalid_argument);
+}
+
+TEST(butterworth_test, retune)
+{
+    const double EPSILON = 1.0e-10;
+
+    std::vector<double> signal;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+    std::vector<double> head(signal.begin(), signal.begin() + 500);
+    std::vector<double> tail(signal.begin() + 500, signal.end());
+
+    struct
+    {
+        int filter_order;
+        filter_design::filter_type type;
+        std::vector<double> from;
+        std::vector<double> to;
+    } sweeps[] = {{5, filter_design::filter_type::lowpass, {10}, {11}},
+                  {4, filter_design::filter_type::highpass, {2}, {2.5}},
+                  {3, filter_design::filter_type::bandpass, {5, 8}, {6, 9}},
+                  {4, filter_design::filter_type::bandstop, {12, 16}, {11, 16}}};
+
+    for (const auto &sweep : sweeps)
+    {
+        // switch immediately: new coefficients (same pairing as a new design), the state is kept
+        butterworth filter{sweep.filter_order, sweep.from, sweep.type, 50, biquad_structure::lattice};
+        butterworth expected{sweep.filter_order, sweep.to, sweep.type, 50, biquad_structure::lattice};
+        filter.process(head);
+        std::vector<double> state(filter.get_state());
+        filter.retune(sweep.to);
+        EXPECT_EQ(sweep.to, filter.get_freq());
+        EXPECT_EQ(state, filter.get_state());
+        for (std::size_t s = 0; s < expected.get_sections().size(); s++)
+        {
+            std::vector<double> c(filter.get_sections()[s].get_coefficients());
+            std::vector<double> e(expected.get_sections()[s].get_coefficients());
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                EXPECT_NEAR(e[i], c[i], EPSILON);
+            }
+        }
+        expected.set_state(state);
+        std::vector<double> result(filter.process(tail));
+        std::vector<double> reference(expected.process(tail));
+        for (std::size_t i = 0; i < tail.size(); i++)
+        {
+            EXPECT_NEAR(reference[i], result[i], EPSILON);
+        }
+    }
+
+    // ramp: the result does not depend on the block size and ends in the new design
+    for (std::size_t interval : {1u, 16u})
+    {
+        butterworth block{6, std::vector<double>{10}, filter_design::filter_type::lowpass, 50, biquad_structure::lattice};
+        butterworth chunked{6, std::vector<double>{10}, filter_design::filter_type::lowpass, 50, biquad_structure::lattice};
+        block.process(head);
+        chunked.process(head);
+        block.retune(std::vector<double>{15}, 200, interval);
+        chunked.retune(std::vector<double>{15}, 200, interval);
+        std::vector<double> result(block.process(tail));
+        for (std::size_t i = 0; i < tail.size(); i += 7)
+        {
+            std::size_t n = std::min<std::size_t>(7, tail.size() - i);
+            std::vector<double> chunk(tail.begin() + i, tail.begin() + i + n);
+            chunk = i % 2 == 0 ? chunked.process(chunk) : std::vector<double>{chunked.process(chunk[0])};
+            if (n == 1 || i % 2 == 0)
+            {
+                for (std::size_t k = 0; k < chunk.size(); k++)
+                {
+                    EXPECT_EQ(result[i + k], chunk[k]);
+                }
+            }
+            else
+            {
+                EXPECT_EQ(result[i], chunk[0]);
+                std::vector<double> rest(chunked.process(std::vector<double>(tail.begin() + i + 1, tail.begin() + i + n)));
+                for (std::size_t k = 0; k < rest.size(); k++)
+                {
+                    EXPECT_EQ(result[i + 1 + k], rest[k]);
+                }
+            }
+        }
+
+        butterworth expected{6, std::vector<double>{15}, filter_design::filter_type::lowpass, 50, biquad_structure::lattice};
+        for (std::size_t s = 0; s < expected.get_sections().size(); s++)
+        {
+            std::vector<double> c(block.get_sections()[s].get_coefficients());
+            std::vector<double> e(expected.get_sections()[s].get_coefficients());
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                EXPECT_NEAR(e[i], c[i], EPSILON);
+            }
+        }
+    }
+
+    butterworth filter{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50};
+    EXPECT_THROW(filter.retune(std::vector<double>{10, 20}), std::invalid_argument);
+    EXPECT_THROW(filter.retune(std::vector<double>{30}), std::invalid_argument);
+    EXPECT_THROW(filter.retune(std::vector<double>{12}, 10, 0), std::invalid_argument);
+    EXPECT_EQ(std::vector<double>{10}, filter.get_freq());
+}
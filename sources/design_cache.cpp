@@ -0,0 +1,120 @@
+#include "design_cache.h"
+
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+    // hash and compare doubles by their bits (exact parameter match, no tolerance)
+    std::uint64_t bits(double value)
+    {
+        std::uint64_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    void hash_combine(std::size_t &seed, std::uint64_t value)
+    {
+        seed ^= std::hash<std::uint64_t>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    }
+} // namespace
+
+bool filter_design::design_cache::key::operator==(const key &other) const
+{
+    if (filter_order != other.filter_order || type != other.type ||
+        bits(sampling_frequency) != bits(other.sampling_frequency) || freq.size() != other.freq.size())
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < freq.size(); i++)
+    {
+        if (bits(freq[i]) != bits(other.freq[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t filter_design::design_cache::key_hash::operator()(const key &k) const
+{
+    std::size_t seed = 0;
+    hash_combine(seed, static_cast<std::uint64_t>(k.filter_order));
+    hash_combine(seed, static_cast<std::uint64_t>(k.type));
+    hash_combine(seed, bits(k.sampling_frequency));
+    for (double f : k.freq)
+    {
+        hash_combine(seed, bits(f));
+    }
+    return seed;
+}
+
+filter_design::design_cache::design_cache(std::size_t capacity)
+    : m_capacity(capacity)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("Capacity of the design cache must be greater than 0");
+    }
+}
+
+filter_design::design_cache::design filter_design::design_cache::get(int filter_order, const std::vector<double> &freq, filter_type type, double sampling_frequency)
+{
+    key k{filter_order, freq, type, sampling_frequency};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(k);
+        if (it != m_index.end())
+        {
+            // move to the front (most recently used)
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+            m_hits++;
+            return it->second->second;
+        }
+    }
+
+    // design outside the lock, so lookups of other parameters are not blocked
+    design sections = std::make_shared<const std::vector<biquad>>(butter(filter_order, freq, type, sampling_frequency));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(k);
+    if (it != m_index.end())
+    {
+        // designed concurrently by another thread, share its design (a hit, the design here is discarded)
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        m_hits++;
+        return it->second->second;
+    }
+    m_misses++;
+    m_entries.emplace_front(k, sections);
+    m_index.emplace(std::move(k), m_entries.begin());
+    if (m_entries.size() > m_capacity)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+    return sections;
+}
+
+std::size_t filter_design::design_cache::get_size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void filter_design::design_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+    m_hits = 0;
+    m_misses = 0;
+}
+
+filter_design::design_cache &filter_design::design_cache::global()
+{
+    static design_cache cache;
+    return cache;
+}
@@ -0,0 +1,105 @@
+#ifndef __DESIGN_CACHE__H__
+#define __DESIGN_CACHE__H__
+
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstddef>
+#include "biquad.h"
+#include "filter_design.h"
+
+namespace filter_design
+{
+    /** Thread-safe, bounded cache of Butterworth designs (see filter_design::butter).
+     *
+     * Designs are keyed by (filter order, critical frequencies, filter type, sampling frequency), the
+     * parameters are compared bit by bit. A repeated parameter tuple returns the same shared, immutable
+     * set of second order sections instead of designing the filter again. When the cache is full, the
+     * least recently used design is evicted (designs still in use stay valid).
+     */
+    class design_cache
+    {
+    public:
+        // shared, immutable second order sections with zero state
+        using design = std::shared_ptr<const std::vector<biquad>>;
+
+    private:
+        struct key
+        {
+            int filter_order;
+            std::vector<double> freq;
+            filter_type type;
+            double sampling_frequency;
+
+            bool operator==(const key &other) const;
+        };
+
+        struct key_hash
+        {
+            std::size_t operator()(const key &k) const;
+        };
+
+        using entry = std::pair<key, design>;
+
+        std::size_t m_capacity;
+        mutable std::mutex m_mutex;
+        std::list<entry> m_entries; // most recently used first
+        std::unordered_map<key, std::list<entry>::iterator, key_hash> m_index;
+        std::atomic<std::size_t> m_hits{0};
+        std::atomic<std::size_t> m_misses{0};
+
+    public:
+        /** Create an empty cache.
+         *
+         * @param capacity maximum number of designs kept, throws std::invalid_argument if 0
+         */
+        explicit design_cache(std::size_t capacity = 256);
+
+        /** Return the design for the parameters, design the filter on a miss.
+         *
+         * Parameters are the same as for filter_design::butter, invalid parameters throw std::invalid_argument
+         * (and are not cached).
+         *
+         * @return shared second order sections
+         */
+        design get(int filter_order, const std::vector<double> &freq, filter_type type, double sampling_frequency);
+
+        /** Get number of lookups that returned a cached design
+         *
+         * @return number of hits
+         */
+        std::size_t get_hits() const { return m_hits; }
+
+        /** Get number of lookups that added a design to the cache
+         *
+         * @return number of misses
+         */
+        std::size_t get_misses() const { return m_misses; }
+
+        /** Get number of cached designs
+         *
+         * @return number of designs
+         */
+        std::size_t get_size() const;
+
+        /** Get maximum number of cached designs
+         *
+         * @return capacity
+         */
+        std::size_t get_capacity() const { return m_capacity; }
+
+        /** Remove all designs and reset the counters. */
+        void clear();
+
+        /** Return the cache shared by the whole process (used by butterworth when asked to use the cache).
+         *
+         * @return process wide cache
+         */
+        static design_cache &global();
+    };
+} // namespace filter_design
+
+#endif //!__DESIGN_CACHE__H__
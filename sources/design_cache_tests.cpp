@@ -0,0 +1,94 @@
+#include <vector>
+#include <thread>
+
+#include "butterworth.h"
+#include "design_cache.h"
+
+#include "gtest/gtest.h"
+
+TEST(design_cache_test, get)
+{
+    filter_design::design_cache cache(2);
+    EXPECT_EQ(2u, cache.get_capacity());
+
+    // a repeated parameter tuple returns the same shared design
+    filter_design::design_cache::design lowpass(cache.get(8, std::vector<double>{15}, filter_design::filter_type::lowpass, 50));
+    EXPECT_EQ(lowpass, cache.get(8, std::vector<double>{15}, filter_design::filter_type::lowpass, 50));
+    EXPECT_EQ(1u, cache.get_hits());
+    EXPECT_EQ(1u, cache.get_misses());
+
+    // the design equals filter_design::butter
+    std::vector<biquad> expected(filter_design::butter(8, std::vector<double>{15}, filter_design::filter_type::lowpass, 50));
+    ASSERT_EQ(expected.size(), lowpass->size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(expected[i].get_coefficients(), (*lowpass)[i].get_coefficients());
+    }
+
+    // every parameter is part of the key
+    EXPECT_NE(lowpass, cache.get(8, std::vector<double>{15}, filter_design::filter_type::highpass, 50));
+    EXPECT_NE(lowpass, cache.get(8, std::vector<double>{15}, filter_design::filter_type::lowpass, 60));
+    EXPECT_NE(lowpass, cache.get(4, std::vector<double>{15}, filter_design::filter_type::lowpass, 50));
+    EXPECT_NE(lowpass, cache.get(8, std::vector<double>{16}, filter_design::filter_type::lowpass, 50));
+    EXPECT_EQ(1u, cache.get_hits());
+    EXPECT_EQ(5u, cache.get_misses());
+
+    // bounded: the least recently used designs were evicted, the evicted design stays valid
+    EXPECT_EQ(2u, cache.get_size());
+    EXPECT_NE(lowpass, cache.get(8, std::vector<double>{15}, filter_design::filter_type::lowpass, 50));
+    EXPECT_EQ(expected.size(), lowpass->size());
+    EXPECT_EQ(6u, cache.get_misses());
+
+    // invalid parameters throw and are not cached
+    EXPECT_THROW(cache.get(8, std::vector<double>{30}, filter_design::filter_type::lowpass, 50), std::invalid_argument);
+    EXPECT_EQ(2u, cache.get_size());
+
+    cache.clear();
+    EXPECT_EQ(0u, cache.get_size());
+    EXPECT_EQ(0u, cache.get_hits());
+    EXPECT_EQ(0u, cache.get_misses());
+    EXPECT_THROW(filter_design::design_cache(0), std::invalid_argument);
+}
+
+TEST(design_cache_test, butterworth)
+{
+    filter_design::design_cache cache;
+    std::vector<double> signal{1, 3, 2, 4, 3};
+    butterworth reference{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+    std::vector<double> expected(reference.process(signal));
+    for (int i = 0; i < 3; i++)
+    {
+        butterworth cached{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50, cache};
+        EXPECT_EQ(expected, cached.process(signal));
+    }
+    basic_butterworth<float> single{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50, cache,
+                                    biquad_structure::transposed_direct_form_2};
+    EXPECT_EQ(biquad_structure::transposed_direct_form_2, single.get_structure());
+    EXPECT_EQ(3u, cache.get_hits());
+    EXPECT_EQ(1u, cache.get_misses());
+}
+
+TEST(design_cache_test, threads)
+{
+    // concurrent lookups of a few parameter tuples
+    filter_design::design_cache cache(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&cache]
+                             {
+                                 for (int i = 0; i < 200; i++)
+                                 {
+                                     int order = 2 + 2 * (i % 3);
+                                     filter_design::design_cache::design design(cache.get(order, std::vector<double>{10}, filter_design::filter_type::lowpass, 50));
+                                     EXPECT_EQ(static_cast<size_t>(order / 2), design->size());
+                                 } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(800u, cache.get_hits() + cache.get_misses());
+    EXPECT_EQ(3u, cache.get_misses());
+    EXPECT_EQ(3u, cache.get_size());
+}
@@ -1,17 +1,15 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
-#include <fstream>
-#include <iterator>
 
 #include "butterworth.h"
+#include "sample_io.h"
 #include "utils.h"
 
-void signal2file(std::vector<double> signal, std::string filename)
+void signal2file(const std::vector<double> &signal, const std::string &filename)
 {
-    std::ofstream output_file(filename);
-    for (const auto &s : signal)
-        output_file << s << "\n";
+    sample_writer writer(filename, file_type::npy, sample_format::float64);
+    writer.write(signal);
 }
 
 std::vector<double> process_batch(std::vector<double> signal, double sampling_frequency)
@@ -44,11 +42,11 @@ int main(int argc, char *argv[])
     std::vector<double> signal;
     for (int t = 0; t <= t_max * sampling_frequency; t++)
         signal.push_back(sin(2 * PI * 5 * t / sampling_frequency));
-    signal2file(signal, "original.txt");
+    signal2file(signal, "original.npy");
 
     std::vector<double> signal_filtered(process_batch(signal, sampling_frequency));
-    signal2file(signal_filtered, "process_batch.txt");
+    signal2file(signal_filtered, "process_batch.npy");
 
     signal_filtered = process_sample(signal, sampling_frequency);
-    signal2file(signal_filtered, "process_sample.txt");
+    signal2file(signal_filtered, "process_sample.npy");
 }
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "file_filter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Write all bytes, continuing after partial writes and interrupts.
+     *
+     * @return false on error (errno is set)
+     */
+    bool write_all(int fd, const unsigned char *data, std::size_t n)
+    {
+        while (n > 0)
+        {
+            ssize_t written = ::write(fd, data, n);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            n -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+} // namespace
+
+bool is_same_file(const std::string &first, const std::string &second)
+{
+    struct stat first_status;
+    struct stat second_status;
+    return ::stat(first.c_str(), &first_status) == 0 && ::stat(second.c_str(), &second_status) == 0 &&
+           first_status.st_dev == second_status.st_dev && first_status.st_ino == second_status.st_ino;
+}
+
+mapped_file::mapped_file(const std::string &path)
+{
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        throw system_error("Cannot open", path);
+    }
+    struct stat status;
+    if (::fstat(m_fd, &status) != 0)
+    {
+        std::runtime_error error(system_error("Cannot stat", path));
+        ::close(m_fd);
+        throw error;
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    if (m_size == 0)
+    {
+        return;
+    }
+    m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (m_data == MAP_FAILED)
+    {
+        std::runtime_error error(system_error("Cannot map", path));
+        ::close(m_fd);
+        throw error;
+    }
+    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+mapped_file::mapped_file(const std::string &path, std::size_t size) : m_size(size)
+{
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0)
+    {
+        throw system_error("Cannot create", path);
+    }
+    if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+    {
+        std::runtime_error error(system_error("Cannot resize", path));
+        ::close(m_fd);
+        throw error;
+    }
+    if (m_size == 0)
+    {
+        return;
+    }
+    // reserve the blocks, a full disk would otherwise raise SIGBUS on a write to the mapping
+    if (int result = ::posix_fallocate(m_fd, 0, static_cast<off_t>(size)))
+    {
+        errno = result;
+        std::runtime_error error(system_error("Cannot allocate", path));
+        ::close(m_fd);
+        throw error;
+    }
+    m_data = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (m_data == MAP_FAILED)
+    {
+        std::runtime_error error(system_error("Cannot map", path));
+        ::close(m_fd);
+        throw error;
+    }
+    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+mapped_file::~mapped_file()
+{
+    if (m_data != nullptr)
+    {
+        ::munmap(m_data, m_size);
+    }
+    ::close(m_fd);
+}
+
+file_filter::file_filter(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                         std::size_t n_channels, sample_format format, std::size_t tile_frames)
+    : m_format(format),
+      m_n_channels(n_channels),
+      m_tile_frames(tile_frames)
+{
+    if (n_channels == 0)
+    {
+        throw std::invalid_argument("Number of channels must be at least 1");
+    }
+    if (m_tile_frames == 0)
+    {
+        m_tile_frames = std::max<std::size_t>(1, TILE_BYTES / (sizeof(double) * n_channels));
+    }
+    if (n_channels == 1)
+    {
+        m_filter = std::make_unique<butterworth>(filter_order, freq, filter_type, sampling_frequency);
+    }
+    else
+    {
+        m_multichannel = std::make_unique<multichannel_butterworth>(filter_order, freq, filter_type, sampling_frequency, n_channels);
+    }
+    m_tile.resize(m_tile_frames * n_channels);
+}
+
+file_filter::~file_filter()
+{
+}
+
+void file_filter::filter_tile(std::size_t n_frames)
+{
+    if (m_filter)
+    {
+        m_filter->process(m_tile.data(), m_tile.data(), n_frames);
+    }
+    else
+    {
+        m_multichannel->process_interleaved(m_tile.data(), m_tile.data(), n_frames);
+    }
+}
+
+void file_filter::process_tile(const unsigned char *in, unsigned char *out, std::size_t n_frames)
+{
+    const std::size_t n = n_frames * m_n_channels;
+    decode_samples(m_format, in, m_tile.data(), n);
+    filter_tile(n_frames);
+    encode_samples(m_format, m_tile.data(), out, n);
+}
+
+void file_filter::process(const void *in, void *out, std::size_t n_frames)
+{
+    const unsigned char *in_bytes = static_cast<const unsigned char *>(in);
+    unsigned char *out_bytes = static_cast<unsigned char *>(out);
+    const std::size_t frame_size = get_frame_size();
+    for (std::size_t frame = 0; frame < n_frames; frame += m_tile_frames)
+    {
+        std::size_t tile_frames = std::min(m_tile_frames, n_frames - frame);
+        process_tile(in_bytes + frame * frame_size, out_bytes + frame * frame_size, tile_frames);
+    }
+}
+
+std::size_t file_filter::process_file(const std::string &input, const std::string &output, bool map_output)
+{
+    mapped_file in(input);
+    const std::size_t frame_size = get_frame_size();
+    if (in.get_size() % frame_size != 0)
+    {
+        throw std::invalid_argument("Size of '" + input + "' is not a multiple of the frame size (" + std::to_string(frame_size) + " bytes)");
+    }
+    // truncating the output would destroy the mapped input
+    if (output != "-" && is_same_file(input, output))
+    {
+        throw std::invalid_argument("Input and output are the same file '" + output + "'");
+    }
+    const std::size_t n_frames = in.get_size() / frame_size;
+    const unsigned char *in_bytes = static_cast<const unsigned char *>(in.get_data());
+
+    if (map_output && output != "-")
+    {
+        mapped_file out(output, in.get_size());
+        process(in_bytes, out.get_data(), n_frames);
+        return n_frames;
+    }
+
+    int fd = STDOUT_FILENO;
+    if (output != "-")
+    {
+        fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw system_error("Cannot create", output);
+        }
+    }
+    std::vector<unsigned char> buffer(m_tile_frames * frame_size);
+    for (std::size_t frame = 0; frame < n_frames; frame += m_tile_frames)
+    {
+        std::size_t tile_frames = std::min(m_tile_frames, n_frames - frame);
+        process_tile(in_bytes + frame * frame_size, buffer.data(), tile_frames);
+        if (!write_all(fd, buffer.data(), tile_frames * frame_size))
+        {
+            std::runtime_error error(system_error("Cannot write", output));
+            if (fd != STDOUT_FILENO)
+            {
+                ::close(fd);
+            }
+            throw error;
+        }
+    }
+    if (fd != STDOUT_FILENO && ::close(fd) != 0)
+    {
+        throw system_error("Cannot close", output);
+    }
+    return n_frames;
+}
+
+std::size_t file_filter::process(sample_reader &reader, sample_writer &writer)
+{
+    if (reader.get_channels() != m_n_channels || writer.get_channels() != m_n_channels)
+    {
+        throw std::invalid_argument("Number of channels of reader and writer must match the filter (" + std::to_string(m_n_channels) + ")");
+    }
+    std::size_t n_frames = 0;
+    while (std::size_t tile_frames = reader.read(m_tile.data(), m_tile_frames))
+    {
+        filter_tile(tile_frames);
+        writer.write(m_tile.data(), tile_frames);
+        n_frames += tile_frames;
+    }
+    return n_frames;
+}
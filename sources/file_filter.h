@@ -0,0 +1,158 @@
+#ifndef __FILE_FILTER__H__
+#define __FILE_FILTER__H__
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "butterworth.h"
+#include "multichannel_butterworth.h"
+#include "sample_io.h"
+
+/** Test whether two paths name the same existing file (same device and inode, e.g. through links).
+ *
+ * @param first path of the first file
+ * @param second path of the second file
+ * @return true if both exist and are the same file
+ */
+bool is_same_file(const std::string &first, const std::string &second);
+
+/** File mapped into memory (POSIX mmap), unmapped and closed on destruction. */
+class mapped_file
+{
+private:
+    int m_fd = -1;
+    void *m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    /** Map an existing file read-only (access is announced as sequential).
+     *
+     * @param path path of the file, throws std::runtime_error if it cannot be opened or mapped
+     */
+    explicit mapped_file(const std::string &path);
+
+    /** Create (or truncate) a file of the given size, reserve its blocks and map it for writing.
+     *
+     * @param path path of the file, throws std::runtime_error if it cannot be created, reserved (e.g. a full
+     *             disk) or mapped
+     * @param size size of the file in bytes
+     */
+    mapped_file(const std::string &path, std::size_t size);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /** Get the mapped bytes (nullptr for an empty file)
+     *
+     * @return start of the mapping
+     */
+    void *get_data() const { return m_data; }
+
+    /** Get the size of the file
+     *
+     * @return size in bytes
+     */
+    std::size_t get_size() const { return m_size; }
+};
+
+/** Butterworth filter for recordings: interleaved frames of int16, int32, float32 or float64 samples.
+ *
+ * Each channel is filtered with its own state. The samples are converted to double precision in tiles of
+ * tile_frames frames that stay in cache, filtered (one channel: block path of butterworth, more channels:
+ * multichannel_butterworth with the channels across SIMD lanes) and converted back to the sample format.
+ * The state carries over between calls, so a recording split into several files or blocks is filtered as
+ * one signal.
+ *
+ * process_file maps a raw input file and writes the output either through a second mapping or with write
+ * calls of one tile each (streamed, also for pipes), so no pass over the data goes through iostreams. WAV and
+ * .npy files are streamed tile by tile through a sample_reader and a sample_writer.
+ */
+class file_filter
+{
+private:
+    sample_format m_format;
+    std::size_t m_n_channels;
+    std::size_t m_tile_frames;
+    std::unique_ptr<butterworth> m_filter;                   // one channel
+    std::unique_ptr<multichannel_butterworth> m_multichannel; // more channels
+    std::vector<double> m_tile;
+
+    void filter_tile(std::size_t n_frames);
+    void process_tile(const unsigned char *in, unsigned char *out, std::size_t n_frames);
+
+public:
+    // default size of a tile of double precision samples (fits into the L2 cache)
+    static constexpr std::size_t TILE_BYTES = 1 << 17;
+
+    /** Butterworth digital filter design for interleaved recordings.
+     *
+     * @param filter_order The order of the filter.
+     * @param freq The critical frequency or frequencies (see butterworth).
+     * @param filter_type The type of filter.
+     * @param sampling_frequency The sampling frequency of the digital system.
+     * @param n_channels number of interleaved channels (throws std::invalid_argument if 0)
+     * @param format sample format of input and output of process and process_file
+     * @param tile_frames frames converted and filtered at once (0 selects TILE_BYTES of samples)
+     */
+    file_filter(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                std::size_t n_channels, sample_format format, std::size_t tile_frames = 0);
+    ~file_filter();
+
+    /** Get number of channels
+     *
+     * @return number of channels
+     */
+    std::size_t get_channels() const { return m_n_channels; }
+
+    /** Get sample format
+     *
+     * @return sample format
+     */
+    sample_format get_format() const { return m_format; }
+
+    /** Get size of one frame (one sample of every channel)
+     *
+     * @return size in bytes
+     */
+    std::size_t get_frame_size() const { return m_n_channels * get_sample_size(m_format); }
+
+    /** Get number of frames per tile
+     *
+     * @return frames per tile
+     */
+    std::size_t get_tile_frames() const { return m_tile_frames; }
+
+    /** Filter frames in memory (e.g. a mapping of the caller).
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input frames in the sample format
+     * @param out output buffer (n_frames frames)
+     * @param n_frames number of frames
+     */
+    void process(const void *in, void *out, std::size_t n_frames);
+
+    /** Filter a raw file into another file.
+     *
+     * @param input path of the input file (its size must be a multiple of the frame size, throws std::invalid_argument otherwise)
+     * @param output path of the output file, created or truncated ("-" streams to the standard output), throws
+     *               std::invalid_argument if it is the input file
+     * @param map_output true: write through a mapping of the output file, false: streamed with write calls
+     * @return number of frames filtered, throws std::runtime_error on I/O errors
+     */
+    std::size_t process_file(const std::string &input, const std::string &output, bool map_output = true);
+
+    /** Filter all remaining frames of a reader into a writer, one tile at a time (any file types and sample
+     * formats, the format of the filter is not used).
+     *
+     * @param reader input, throws std::invalid_argument if its number of channels differs from the filter
+     * @param writer output, throws std::invalid_argument if its number of channels differs from the filter
+     * @return number of frames filtered
+     */
+    std::size_t process(sample_reader &reader, sample_writer &writer);
+};
+
+#endif //!__FILE_FILTER__H__
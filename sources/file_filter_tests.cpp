@@ -0,0 +1,202 @@
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include "butterworth.h"
+#include "file_filter.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    const std::size_t N_FRAMES = 5000;
+
+    // interleaved frames, every channel a different signal
+    std::vector<double> test_frames(std::size_t n_channels, double amplitude)
+    {
+        std::vector<double> frames;
+        for (std::size_t i = 0; i < N_FRAMES; i++)
+        {
+            for (std::size_t ch = 0; ch < n_channels; ch++)
+            {
+                frames.push_back(amplitude * (0.6 * std::sin(0.02 * (ch + 1) * i) + 0.3 * std::sin(1.7 * i + ch)));
+            }
+        }
+        return frames;
+    }
+
+    // every channel through its own butterworth
+    std::vector<double> reference(const std::vector<double> &frames, std::size_t n_channels)
+    {
+        std::vector<double> result(frames.size());
+        for (std::size_t ch = 0; ch < n_channels; ch++)
+        {
+            butterworth filter(6, {0.2}, filter_design::filter_type::lowpass, 2);
+            for (std::size_t i = ch; i < frames.size(); i += n_channels)
+            {
+                result[i] = filter.process(frames[i]);
+            }
+        }
+        return result;
+    }
+
+    template <typename S>
+    void write_file(const std::string &path, const std::vector<S> &samples)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(S));
+    }
+
+    template <typename S>
+    std::vector<S> read_file(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::vector<S> samples(bytes.size() / sizeof(S));
+        std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char *>(samples.data()));
+        return samples;
+    }
+}
+
+TEST(file_filter_test, process)
+{
+    const double EPSILON = 1e-10;
+    for (std::size_t n_channels : {1, 3, 8})
+    {
+        std::vector<double> frames(test_frames(n_channels, 1));
+        std::vector<double> expected(reference(frames, n_channels));
+
+        // small tiles, split over two calls and in place
+        file_filter filter(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::float64, 77);
+        EXPECT_EQ(n_channels * sizeof(double), filter.get_frame_size());
+        filter.process(frames.data(), frames.data(), 1000);
+        filter.process(frames.data() + 1000 * n_channels, frames.data() + 1000 * n_channels, N_FRAMES - 1000);
+        for (std::size_t i = 0; i < frames.size(); i++)
+        {
+            ASSERT_NEAR(expected[i], frames[i], EPSILON) << n_channels << " channels, sample " << i;
+        }
+    }
+}
+
+TEST(file_filter_test, process_file)
+{
+    const std::size_t n_channels = 3;
+    const std::string input = ::testing::TempDir() + "file_filter_input.raw";
+    const std::string output = ::testing::TempDir() + "file_filter_output.raw";
+
+    // float64, mapped and streamed output
+    std::vector<double> frames(test_frames(n_channels, 1));
+    std::vector<double> expected(reference(frames, n_channels));
+    write_file(input, frames);
+    for (bool map_output : {true, false})
+    {
+        file_filter filter(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::float64);
+        EXPECT_EQ(N_FRAMES, filter.process_file(input, output, map_output));
+        std::vector<double> result(read_file<double>(output));
+        ASSERT_EQ(expected.size(), result.size());
+        for (std::size_t i = 0; i < result.size(); i++)
+        {
+            ASSERT_NEAR(expected[i], result[i], 1e-10);
+        }
+    }
+
+    // float32
+    std::vector<float> frames_f32(frames.begin(), frames.end());
+    write_file(input, frames_f32);
+    file_filter filter_f32(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::float32);
+    EXPECT_EQ(N_FRAMES, filter_f32.process_file(input, output));
+    std::vector<float> result_f32(read_file<float>(output));
+    ASSERT_EQ(expected.size(), result_f32.size());
+    for (std::size_t i = 0; i < result_f32.size(); i++)
+    {
+        ASSERT_NEAR(expected[i], result_f32[i], 1e-5);
+    }
+
+    // int16: filtered in the integer scale, rounded and saturated
+    std::vector<double> frames_s16(test_frames(n_channels, 40000));
+    std::vector<std::int16_t> samples_s16;
+    for (double sample : frames_s16)
+    {
+        samples_s16.push_back(static_cast<std::int16_t>(std::max(-32768.0, std::min(32767.0, std::round(sample)))));
+    }
+    std::vector<double> expected_s16(reference(std::vector<double>(samples_s16.begin(), samples_s16.end()), n_channels));
+    write_file(input, samples_s16);
+    file_filter filter_s16(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::int16);
+    EXPECT_EQ(N_FRAMES, filter_s16.process_file(input, output, false));
+    std::vector<std::int16_t> result_s16(read_file<std::int16_t>(output));
+    ASSERT_EQ(expected_s16.size(), result_s16.size());
+    for (std::size_t i = 0; i < result_s16.size(); i++)
+    {
+        ASSERT_NEAR(std::max(-32768.0, std::min(32767.0, expected_s16[i])), result_s16[i], 0.5 + 1e-6);
+    }
+
+    // size is not a multiple of the frame size
+    write_file(input, std::vector<double>(3 * n_channels + 1));
+    EXPECT_THROW(filter_s16.process_file(input, output), std::invalid_argument);
+    EXPECT_THROW(filter_s16.process_file(input + ".missing", output), std::runtime_error);
+
+    // the output must not truncate the mapped input, also when reached through a link
+    write_file(input, frames);
+    const std::string link = ::testing::TempDir() + "file_filter_link.raw";
+    std::remove(link.c_str());
+    ASSERT_EQ(0, ::link(input.c_str(), link.c_str()));
+    EXPECT_TRUE(is_same_file(input, link));
+    EXPECT_FALSE(is_same_file(input, output));
+    for (bool map_output : {true, false})
+    {
+        file_filter filter(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::float64);
+        EXPECT_THROW(filter.process_file(input, input, map_output), std::invalid_argument);
+        EXPECT_THROW(filter.process_file(input, link, map_output), std::invalid_argument);
+    }
+    EXPECT_EQ(frames, read_file<double>(input));
+
+    std::remove(link.c_str());
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+TEST(file_filter_test, process_stream)
+{
+    const std::size_t n_channels = 2;
+    const std::string input = ::testing::TempDir() + "file_filter_input.npy";
+    const std::string output = ::testing::TempDir() + "file_filter_output.wav";
+
+    std::vector<double> frames(test_frames(n_channels, 1));
+    std::vector<double> expected(reference(frames, n_channels));
+    {
+        sample_writer writer(input, file_type::npy, sample_format::float64, n_channels);
+        writer.write(frames);
+    }
+
+    file_filter filter(6, {0.2}, filter_design::filter_type::lowpass, 2, n_channels, sample_format::float64, 300);
+    {
+        sample_reader reader(input);
+        sample_writer writer(output, file_type::wav, sample_format::float32, n_channels, 48000);
+        EXPECT_EQ(N_FRAMES, filter.process(reader, writer));
+    }
+    sample_reader reader(output);
+    EXPECT_EQ(48000, reader.get_sampling_frequency());
+    std::vector<double> result(reader.read());
+    ASSERT_EQ(expected.size(), result.size());
+    for (std::size_t i = 0; i < result.size(); i++)
+    {
+        ASSERT_NEAR(expected[i], result[i], 1e-5);
+    }
+
+    sample_reader mono(input, file_type::raw, sample_format::float64, 1);
+    sample_writer writer(output, file_type::raw, sample_format::float64, n_channels);
+    EXPECT_THROW(filter.process(mono, writer), std::invalid_argument);
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+TEST(file_filter_test, channels)
+{
+    EXPECT_THROW(file_filter(4, {0.2}, filter_design::filter_type::lowpass, 2, 0, sample_format::float32), std::invalid_argument);
+}
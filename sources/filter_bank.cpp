@@ -0,0 +1,117 @@
+#include "filter_bank.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template <typename T>
+basic_filter_bank<T>::basic_filter_bank(const filter_design::bank &bank, bool energy)
+    : m_kernels(&simd::get_kernels()),
+      m_kernel(&m_kernels->get_bank<T>()),
+      m_bank(bank),
+      m_n_bands(bank.sections.size()),
+      m_n_padded_bands((m_n_bands + m_kernel->lanes - 1) / m_kernel->lanes * m_kernel->lanes),
+      m_n_sections(0),
+      m_energy_enabled(energy)
+{
+    if (m_n_bands == 0)
+    {
+        throw std::invalid_argument("Filter bank needs at least one band");
+    }
+    for (const std::vector<biquad> &sections : bank.sections)
+    {
+        m_n_sections = std::max(m_n_sections, sections.size());
+    }
+
+    // padding bands stay at zero, padding sections pass the signal through
+    m_coefficients.assign(5 * m_n_sections * m_n_padded_bands, T(0));
+    for (std::size_t b = 0; b < m_n_bands; b++)
+    {
+        const std::vector<biquad> &sections = bank.sections[b];
+        for (std::size_t s = 0; s < m_n_sections; s++)
+        {
+            std::vector<double> coefficients(s < sections.size() ? sections[s].get_coefficients() : std::vector<double>{1, 0, 0, 0, 0});
+            for (std::size_t c = 0; c < 5; c++)
+            {
+                m_coefficients[(5 * s + c) * m_n_padded_bands + b] = static_cast<T>(coefficients[c]);
+            }
+        }
+    }
+    m_state.assign(2 * m_n_sections * m_n_padded_bands, T(0));
+    m_energy.assign(m_n_padded_bands, T(0));
+}
+
+template <typename T>
+basic_filter_bank<T>::basic_filter_bank(int filter_order, const std::vector<std::vector<double>> &bands, filter_design::filter_type filter_type, double sampling_frequency,
+                                        bool energy)
+    : basic_filter_bank(filter_design::design_bank(filter_order, bands, filter_type, sampling_frequency), energy)
+{
+}
+
+template <typename T>
+void basic_filter_bank<T>::process(const T *in, T *const *out, std::size_t n)
+{
+    const std::size_t lanes = m_kernel->lanes;
+    alignas(64) T buffer[simd::TILE_SIZE * simd::MAX_LANE_BYTES / sizeof(T)];
+
+    for (std::size_t tile = 0; tile < n; tile += simd::TILE_SIZE)
+    {
+        // the tile of the input stays in L1 cache while all band groups read it
+        std::size_t tile_size = std::min(simd::TILE_SIZE, n - tile);
+        for (std::size_t band = 0; band < m_n_bands; band += lanes)
+        {
+            std::size_t n_lanes = std::min(lanes, m_n_bands - band);
+            m_kernel->process(m_coefficients.data() + band, m_n_sections, m_state.data() + band, m_n_padded_bands,
+                              in + tile, (out != nullptr) ? buffer : nullptr,
+                              m_energy_enabled ? m_energy.data() + band : nullptr, tile_size);
+            if (out == nullptr)
+            {
+                continue;
+            }
+
+            // planar outputs
+            for (std::size_t l = 0; l < n_lanes; l++)
+            {
+                T *samples = out[band + l] + tile;
+                for (std::size_t i = 0; i < tile_size; i++)
+                {
+                    samples[i] = buffer[i * lanes + l];
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+std::vector<std::vector<T>> basic_filter_bank<T>::process(const std::vector<T> &samples)
+{
+    std::vector<std::vector<T>> result(m_n_bands, std::vector<T>(samples.size()));
+    std::vector<T *> out;
+    for (std::vector<T> &band : result)
+    {
+        out.push_back(band.data());
+    }
+    process(samples.data(), out.data(), samples.size());
+    return result;
+}
+
+template <typename T>
+std::vector<T> basic_filter_bank<T>::get_energy() const
+{
+    return std::vector<T>(m_energy.begin(), m_energy.begin() + m_n_bands);
+}
+
+template <typename T>
+void basic_filter_bank<T>::reset_energy()
+{
+    std::fill(m_energy.begin(), m_energy.end(), T(0));
+}
+
+template <typename T>
+void basic_filter_bank<T>::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), T(0));
+    reset_energy();
+}
+
+template class basic_filter_bank<double>;
+template class basic_filter_bank<float>;
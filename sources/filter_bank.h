@@ -0,0 +1,113 @@
+#ifndef __FILTER_BANK__H__
+#define __FILTER_BANK__H__
+
+#include <vector>
+#include <cstddef>
+#include "biquad.h"
+#include "filter_design.h"
+#include "simd_dispatch.h"
+
+/** Bank of filters applied to one input signal (e.g. 1/3-octave or mel analysis).
+ *
+ * @tparam T sample, coefficient and state type (explicitly instantiated for float and double,
+ *           float doubles the number of lanes)
+ *
+ * Every band has its own cascade. The coefficients and the state are stored as structure of arrays (per
+ * section and coefficient or state word one contiguous array over the bands), so the cascades of a group
+ * of bands are evaluated in the lanes of SIMD registers. The input is processed in tiles that stay in L1
+ * cache while all band groups read them, a block of N bands costs about one pass over the input and one
+ * pass over the outputs. The sections are realized in transposed direct form 2. The kernels of the
+ * instruction set selected by simd::get_kernels() at construction are used for the lifetime of the bank.
+ */
+template <typename T>
+class basic_filter_bank
+{
+private:
+    const simd::kernels *m_kernels;       // kernels selected at construction
+    const simd::bank_kernel<T> *m_kernel; // kernel for the sample type
+    filter_design::bank m_bank;
+    std::size_t m_n_bands;
+    std::size_t m_n_padded_bands; // bands rounded up to a multiple of the lane count
+    std::size_t m_n_sections;     // sections of the longest cascade, shorter cascades are padded
+    bool m_energy_enabled;
+    std::vector<T> m_coefficients; // [section][b0, b1, b2, a1, a2][padded band]
+    std::vector<T> m_state;        // [section][s1, s2][padded band]
+    std::vector<T> m_energy;       // [padded band]
+
+public:
+    /** Filter bank with the sections of a designed bank.
+     *
+     * @param bank second order sections of every band (see filter_design::design_bank), throws
+     *             std::invalid_argument if it has no bands. Cascades with fewer sections than the longest
+     *             one are padded with pass-through sections.
+     * @param energy accumulate the energy of every band (see get_energy)
+     */
+    explicit basic_filter_bank(const filter_design::bank &bank, bool energy = false);
+
+    /** Butterworth filter bank (see filter_design::design_bank).
+     *
+     * @param filter_order The order of the filters.
+     * @param bands The critical frequency or frequencies of every band.
+     * @param filter_type The type of the filters.
+     * @param sampling_frequency The sampling frequency of the digital system.
+     * @param energy accumulate the energy of every band (see get_energy)
+     */
+    basic_filter_bank(int filter_order, const std::vector<std::vector<double>> &bands, filter_design::filter_type filter_type, double sampling_frequency,
+                      bool energy = false);
+
+    /** Get the design of the bank
+     *
+     * @return critical frequencies and second order sections of every band
+     */
+    const filter_design::bank &get_bank() const { return m_bank; }
+
+    /** Get number of bands
+     *
+     * @return number of bands
+     */
+    std::size_t get_bands() const { return m_n_bands; }
+
+    /** Get number of bands processed in parallel (SIMD lanes)
+     *
+     * @return number of lanes
+     */
+    std::size_t get_lanes() const { return m_kernel->lanes; }
+
+    /** Get the instruction set of the kernels used by this bank
+     *
+     * @return instruction set
+     */
+    simd::instruction_set get_instruction_set() const { return m_kernels->isa; }
+
+    /** Process a block of the input signal.
+     *
+     * @param in input samples
+     * @param out output buffers (n_bands buffers with at least n samples), or nullptr to only measure the energy
+     * @param n number of samples
+     */
+    void process(const T *in, T *const *out, std::size_t n);
+
+    /** Process the input signal.
+     *
+     * @param samples input samples
+     * @return output of every band (planar)
+     */
+    std::vector<std::vector<T>> process(const std::vector<T> &samples);
+
+    /** Get the energy of every band (sum of the squared outputs since construction, reset or reset_energy).
+     *
+     * @return energy per band, zero if the bank does not accumulate the energy
+     */
+    std::vector<T> get_energy() const;
+
+    /** Reset the energy of all bands to zero. */
+    void reset_energy();
+
+    /** Reset the state and the energy of all bands to zero. */
+    void reset();
+};
+
+// double precision samples, coefficients and state
+using filter_bank = basic_filter_bank<double>;
+
+#endif //!__FILTER_BANK__H__
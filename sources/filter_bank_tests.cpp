@@ -0,0 +1,131 @@
+#include <vector>
+#include <cmath>
+
+#include "butterworth.h"
+#include "filter_bank.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::vector<double> test_signal(std::size_t n_samples)
+    {
+        std::vector<double> signal;
+        for (std::size_t i = 0; i < n_samples; i++)
+        {
+            signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i) + 0.25 * std::sin(2.9 * i));
+        }
+        return signal;
+    }
+
+    // n_bands octave wide bands between 100 Hz and 20 kHz at 48 kHz
+    std::vector<std::vector<double>> test_bands(std::size_t n_bands)
+    {
+        std::vector<std::vector<double>> bands;
+        for (std::size_t b = 0; b < n_bands; b++)
+        {
+            double center = 100 * std::pow(150.0, static_cast<double>(b) / n_bands);
+            bands.push_back({center / std::sqrt(2.0), center * std::sqrt(2.0)});
+        }
+        return bands;
+    }
+}
+
+TEST(filter_bank_test, process)
+{
+    const double EPSILON = 1.0e-9;
+
+    for (simd::instruction_set isa : simd::supported_instruction_sets())
+    {
+        simd::set_instruction_set(isa);
+
+        // band counts below, equal to and above a multiple of the lane count
+        std::size_t lanes = simd::get_kernels().bank_f64.lanes;
+        for (std::size_t n_bands : {std::size_t(1), std::size_t(3), lanes, lanes + 5})
+        {
+            std::size_t n_samples = 300;
+            std::vector<double> signal(test_signal(n_samples));
+            std::vector<std::vector<double>> bands(test_bands(n_bands));
+
+            filter_bank bank{4, bands, filter_design::filter_type::bandpass, 48000, true};
+            EXPECT_EQ(n_bands, bank.get_bands());
+            EXPECT_EQ(lanes, bank.get_lanes());
+            EXPECT_EQ(isa, bank.get_instruction_set());
+
+            // a block, a single sample and the rest
+            std::vector<std::vector<double>> result(n_bands, std::vector<double>(n_samples));
+            std::vector<double *> out;
+            for (std::vector<double> &band : result)
+            {
+                out.push_back(band.data());
+            }
+            bank.process(signal.data(), out.data(), 100);
+            for (double *&o : out)
+            {
+                o += 100;
+            }
+            bank.process(signal.data() + 100, out.data(), 1);
+            for (double *&o : out)
+            {
+                o += 1;
+            }
+            bank.process(signal.data() + 101, out.data(), n_samples - 101);
+
+            std::vector<double> energy(bank.get_energy());
+            ASSERT_EQ(n_bands, energy.size());
+            for (std::size_t b = 0; b < n_bands; b++)
+            {
+                butterworth filter{4, bands[b], filter_design::filter_type::bandpass, 48000};
+                std::vector<double> expected(filter.process(signal));
+                double expected_energy = 0;
+                for (std::size_t i = 0; i < n_samples; i++)
+                {
+                    EXPECT_NEAR(expected[i], result[b][i], EPSILON);
+                    expected_energy += expected[i] * expected[i];
+                }
+                EXPECT_NEAR(expected_energy, energy[b], EPSILON * n_samples);
+            }
+
+            // energy only, the state continues
+            bank.reset();
+            EXPECT_EQ(std::vector<double>(n_bands, 0.0), bank.get_energy());
+            bank.process(signal.data(), nullptr, n_samples);
+            std::vector<double> only_energy(bank.get_energy());
+            for (std::size_t b = 0; b < n_bands; b++)
+            {
+                EXPECT_NEAR(energy[b], only_energy[b], EPSILON * n_samples);
+            }
+        }
+    }
+    simd::reset_instruction_set();
+}
+
+TEST(filter_bank_test, design)
+{
+    const double EPSILON = 1.0e-4;
+
+    // cascades of different length (a lowpass and a bandpass) in single precision
+    std::vector<double> signal(test_signal(500));
+    filter_design::bank design{{{1000}, {2000, 4000}}, {}, 48000};
+    design.sections.push_back(filter_design::butter(3, design.bands[0], filter_design::filter_type::lowpass, 48000));
+    design.sections.push_back(filter_design::butter(4, design.bands[1], filter_design::filter_type::bandpass, 48000));
+    basic_filter_bank<float> bank{design};
+    EXPECT_EQ(design.bands, bank.get_bank().bands);
+
+    std::vector<float> samples(signal.begin(), signal.end());
+    std::vector<std::vector<float>> result(bank.process(samples));
+    ASSERT_EQ(2u, result.size());
+    EXPECT_EQ(std::vector<float>(2, 0.0f), bank.get_energy());
+
+    butterworth lowpass{3, design.bands[0], filter_design::filter_type::lowpass, 48000};
+    butterworth bandpass{4, design.bands[1], filter_design::filter_type::bandpass, 48000};
+    std::vector<double> expected_lowpass(lowpass.process(signal));
+    std::vector<double> expected_bandpass(bandpass.process(signal));
+    for (std::size_t i = 0; i < signal.size(); i++)
+    {
+        EXPECT_NEAR(expected_lowpass[i], result[0][i], EPSILON);
+        EXPECT_NEAR(expected_bandpass[i], result[1][i], EPSILON);
+    }
+
+    EXPECT_THROW(filter_bank(filter_design::bank{}), std::invalid_argument);
+}
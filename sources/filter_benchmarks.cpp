@@ -0,0 +1,364 @@
+#include <vector>
+#include <array>
+#include <cmath>
+#include <thread>
+
+#include "biquad.h"
+#include "butterworth.h"
+#include "filter_design.h"
+#include "design_cache.h"
+#include "file_filter.h"
+#include "filter_bank.h"
+#include "multichannel_butterworth.h"
+#include "multirate.h"
+#include "static_design.h"
+#include "stream_executor.h"
+#include "stream_stage.h"
+#include "utils.h"
+
+#include "benchmark/benchmark.h"
+
+// Throughput is reported as items_per_second (samples/second) and time/sample (seconds, printed with
+// SI prefix, so "25n" is 25 ns/sample). Run e.g. with --benchmark_filter=butterworth_process to select.
+// The filters read the same input every iteration and write to a separate buffer, filtering the output
+// again would decay the signal to denormals (slow) or zero (fast) over the iterations.
+
+namespace
+{
+    const filter_design::filter_type FILTER_TYPES[]{filter_design::filter_type::lowpass,
+                                                    filter_design::filter_type::highpass,
+                                                    filter_design::filter_type::bandpass,
+                                                    filter_design::filter_type::bandstop};
+
+    std::vector<double> critical_frequencies(filter_design::filter_type filter_type)
+    {
+        if (filter_type == filter_design::filter_type::bandpass || filter_type == filter_design::filter_type::bandstop)
+        {
+            return std::vector<double>{10, 20};
+        }
+        return std::vector<double>{10};
+    }
+
+    template <typename T>
+    std::vector<T> test_signal(std::size_t n)
+    {
+        std::vector<T> signal;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            signal.push_back(static_cast<T>(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i)));
+        }
+        return signal;
+    }
+
+    void set_counters(benchmark::State &state, std::size_t samples_per_iteration)
+    {
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * samples_per_iteration));
+        state.counters["time/sample"] = benchmark::Counter(static_cast<double>(samples_per_iteration),
+                                                           benchmark::Counter::kIsIterationInvariantRate |
+                                                               benchmark::Counter::kInvert);
+    }
+} // namespace
+
+// single biquad, args: block size
+template <typename T>
+void biquad_process(benchmark::State &state)
+{
+    std::size_t block_size = static_cast<std::size_t>(state.range(0));
+    basic_biquad<T> biquad(0.4, 0.3, -0.2, -0.5, 0.25);
+    const std::vector<T> signal(test_signal<T>(block_size));
+    std::vector<T> out(block_size);
+    for (auto _ : state)
+    {
+        biquad.process(signal.data(), out.data(), signal.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, block_size);
+}
+BENCHMARK_TEMPLATE(biquad_process, double)->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(biquad_process, float)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+// cascade, args: filter order, filter type, block size, batch mode
+template <typename T>
+void butterworth_process(benchmark::State &state)
+{
+    filter_design::filter_type filter_type = FILTER_TYPES[state.range(1)];
+    std::size_t block_size = static_cast<std::size_t>(state.range(2));
+    basic_butterworth<T> filter(static_cast<int>(state.range(0)), critical_frequencies(filter_type), filter_type, 50);
+    filter.set_batch_mode(static_cast<batch_mode>(state.range(3)));
+    const std::vector<T> signal(test_signal<T>(block_size));
+    std::vector<T> out(block_size);
+    for (auto _ : state)
+    {
+        filter.process(signal.data(), out.data(), signal.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, block_size);
+}
+BENCHMARK_TEMPLATE(butterworth_process, double)
+    ->ArgNames({"order", "type", "block", "mode"})
+    ->ArgsProduct({{2, 4, 8, 16}, {0, 2}, {64, 1024, 1 << 16}, {static_cast<int64_t>(batch_mode::fused), static_cast<int64_t>(batch_mode::per_section)}});
+BENCHMARK_TEMPLATE(butterworth_process, float)
+    ->ArgNames({"order", "type", "block", "mode"})
+    ->ArgsProduct({{2, 4, 8, 16}, {0, 2}, {64, 1024, 1 << 16}, {static_cast<int64_t>(batch_mode::fused), static_cast<int64_t>(batch_mode::per_section)}});
+
+// cascade sample by sample, args: filter order
+template <typename T>
+void butterworth_process_sample(benchmark::State &state)
+{
+    basic_butterworth<T> filter(static_cast<int>(state.range(0)), std::vector<double>{10}, filter_design::filter_type::lowpass, 50);
+    const std::vector<T> signal(test_signal<T>(1024));
+    std::vector<T> out(signal.size());
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < signal.size(); i++)
+        {
+            out[i] = filter.process(signal[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, signal.size());
+}
+BENCHMARK_TEMPLATE(butterworth_process_sample, double)->ArgName("order")->Arg(2)->Arg(8)->Arg(16);
+BENCHMARK_TEMPLATE(butterworth_process_sample, float)->ArgName("order")->Arg(2)->Arg(8)->Arg(16);
+
+// multichannel cascade (interleaved), args: channels, frames per block; time/sample is per channel sample
+template <typename T>
+void multichannel_process(benchmark::State &state)
+{
+    std::size_t n_channels = static_cast<std::size_t>(state.range(0));
+    std::size_t n_frames = static_cast<std::size_t>(state.range(1));
+    basic_multichannel_butterworth<T> filter(8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, n_channels);
+    const std::vector<T> signal(test_signal<T>(n_channels * n_frames));
+    std::vector<T> out(signal.size());
+    for (auto _ : state)
+    {
+        filter.process_interleaved(signal.data(), out.data(), n_frames);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, n_channels * n_frames);
+}
+BENCHMARK_TEMPLATE(multichannel_process, double)
+    ->ArgNames({"channels", "block"})
+    ->ArgsProduct({{1, 8, 64, 256}, {64, 1024}});
+BENCHMARK_TEMPLATE(multichannel_process, float)
+    ->ArgNames({"channels", "block"})
+    ->ArgsProduct({{1, 8, 64, 256}, {64, 1024}});
+
+// bank of bandpass filters on one input, args: number of bands, block size
+void filter_bank_process(benchmark::State &state)
+{
+    std::size_t n_bands = static_cast<std::size_t>(state.range(0));
+    std::size_t n_samples = static_cast<std::size_t>(state.range(1));
+    std::vector<std::vector<double>> bands;
+    for (std::size_t b = 0; b < n_bands; b++)
+    {
+        double center = 20 * std::pow(1000.0, static_cast<double>(b) / n_bands);
+        bands.push_back({center * 0.9, center * 1.1});
+    }
+    filter_bank bank(4, bands, filter_design::filter_type::bandpass, 48000);
+    std::vector<double> signal(test_signal<double>(n_samples));
+    std::vector<std::vector<double>> outputs(n_bands, std::vector<double>(n_samples));
+    std::vector<double *> out;
+    for (std::vector<double> &output : outputs)
+    {
+        out.push_back(output.data());
+    }
+    for (auto _ : state)
+    {
+        bank.process(signal.data(), out.data(), n_samples);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, n_bands * n_samples);
+}
+BENCHMARK(filter_bank_process)->ArgNames({"bands", "block"})->ArgsProduct({{8, 32, 128}, {64, 4096}});
+
+// anti-aliasing lowpass and downsampling in one stage, args: factor, filter order (per input sample)
+void decimator_process(benchmark::State &state)
+{
+    decimator stage(static_cast<std::size_t>(state.range(0)), static_cast<int>(state.range(1)));
+    std::vector<double> signal(test_signal<double>(4096));
+    std::vector<double> out(stage.get_output_size(signal.size()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(stage.process(signal.data(), out.data(), signal.size()));
+    }
+    set_counters(state, signal.size());
+}
+BENCHMARK(decimator_process)->ArgNames({"factor", "order"})->ArgsProduct({{2, 8, 64}, {4, 8}});
+
+// zero stuffing and anti-imaging lowpass in one stage, args: factor, filter order (per output sample)
+void interpolator_process(benchmark::State &state)
+{
+    std::size_t factor = static_cast<std::size_t>(state.range(0));
+    interpolator stage(factor, static_cast<int>(state.range(1)));
+    std::vector<double> signal(test_signal<double>(4096 / factor));
+    std::vector<double> out(signal.size() * factor);
+    for (auto _ : state)
+    {
+        stage.process(signal.data(), out.data(), signal.size());
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, out.size());
+}
+BENCHMARK(interpolator_process)->ArgNames({"factor", "order"})->ArgsProduct({{2, 8, 64}, {4, 8}});
+
+// handoff through the streaming stage (push and pop from the benchmark thread, filtering on the worker),
+// args: block size
+void stream_stage_process(benchmark::State &state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    stream_stage stage(butterworth(8, {10}, filter_design::filter_type::lowpass, 50));
+    std::vector<double> signal(test_signal<double>(n));
+    std::vector<double> out(n);
+    for (auto _ : state)
+    {
+        stage.push(signal.data(), n);
+        for (std::size_t received = 0; received < n;)
+        {
+            std::size_t count = stage.pop(out.data() + received, n - received);
+            if (count == 0)
+            {
+                std::this_thread::yield();
+            }
+            received += count;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, n);
+}
+BENCHMARK(stream_stage_process)->ArgName("block")->RangeMultiplier(8)->Range(64, 4096);
+
+// one block for each of many streams per iteration, args: number of streams, block size
+void stream_executor_process(benchmark::State &state)
+{
+    std::size_t n_streams = static_cast<std::size_t>(state.range(0));
+    std::size_t n = static_cast<std::size_t>(state.range(1));
+    stream_executor executor;
+    for (std::size_t s = 0; s < n_streams; s++)
+    {
+        executor.add_stream(butterworth(8, {1.0 + s % 20}, filter_design::filter_type::lowpass, 50));
+    }
+    std::vector<double> signal(test_signal<double>(n));
+    std::vector<double> out(n_streams * n);
+    for (auto _ : state)
+    {
+        for (std::size_t s = 0; s < n_streams; s++)
+        {
+            executor.submit(s, signal.data(), out.data() + s * n, n);
+        }
+        executor.wait();
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, n_streams * n);
+}
+BENCHMARK(stream_executor_process)->ArgNames({"streams", "block"})->ArgsProduct({{64, 1024}, {64, 1024}})->UseRealTime();
+
+// raw interleaved float32 frames converted and filtered in tiles, args: number of channels
+void file_filter_process(benchmark::State &state)
+{
+    std::size_t n_channels = static_cast<std::size_t>(state.range(0));
+    std::size_t n_frames = 1 << 16;
+    file_filter filter(8, {10}, filter_design::filter_type::lowpass, 50, n_channels, sample_format::float32);
+    std::vector<float> frames(test_signal<float>(n_frames * n_channels));
+    std::vector<float> out(frames.size());
+    for (auto _ : state)
+    {
+        filter.process(frames.data(), out.data(), n_frames);
+        benchmark::DoNotOptimize(out.data());
+    }
+    set_counters(state, n_frames * n_channels);
+}
+BENCHMARK(file_filter_process)->ArgName("channels")->Arg(1)->Arg(4)->Arg(16);
+
+// full design (prototype, transform, bilinear transform, zpk2sos), args: filter order, filter type
+void butterworth_design(benchmark::State &state)
+{
+    filter_design::filter_type filter_type = FILTER_TYPES[state.range(1)];
+    std::vector<double> freq(critical_frequencies(filter_type));
+    for (auto _ : state)
+    {
+        butterworth filter(static_cast<int>(state.range(0)), freq, filter_type, 50);
+        benchmark::DoNotOptimize(filter);
+    }
+}
+BENCHMARK(butterworth_design)->ArgNames({"order", "type"})->ArgsProduct({{2, 4, 8, 16, 32}, {0, 1, 2, 3}});
+
+// construction with the design taken from the cache, args: filter order, filter type
+void butterworth_design_cached(benchmark::State &state)
+{
+    filter_design::filter_type filter_type = FILTER_TYPES[state.range(1)];
+    std::vector<double> freq(critical_frequencies(filter_type));
+    filter_design::design_cache cache;
+    for (auto _ : state)
+    {
+        butterworth filter(static_cast<int>(state.range(0)), freq, filter_type, 50, cache);
+        benchmark::DoNotOptimize(filter);
+    }
+}
+BENCHMARK(butterworth_design_cached)->ArgNames({"order", "type"})->ArgsProduct({{2, 4, 8, 16, 32}, {0, 1, 2, 3}});
+
+// design of a filter bank (bandpass), args: filter order, number of bands
+void butterworth_design_bank(benchmark::State &state)
+{
+    std::vector<std::vector<double>> bands;
+    for (int64_t b = 0; b < state.range(1); b++)
+    {
+        double center = 20 * std::pow(1000.0, static_cast<double>(b) / state.range(1));
+        bands.push_back({center * 0.9, center * 1.1});
+    }
+    for (auto _ : state)
+    {
+        filter_design::bank bank(filter_design::design_bank(static_cast<int>(state.range(0)), bands, filter_design::filter_type::bandpass, 48000));
+        benchmark::DoNotOptimize(bank);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(butterworth_design_bank)->ArgNames({"order", "bands"})->ArgsProduct({{4, 8}, {32, 256}});
+
+// design on fixed capacity storage (no heap allocation), args: filter order, filter type
+void butterworth_design_fixed(benchmark::State &state)
+{
+    filter_design::filter_type filter_type = FILTER_TYPES[state.range(1)];
+    std::vector<double> freq(critical_frequencies(filter_type));
+    std::array<std::array<double, 5>, 32> sections;
+    for (auto _ : state)
+    {
+        std::size_t n = static_design::butter<32>(static_cast<int>(state.range(0)), freq.data(), filter_type, 50, sections.data());
+        benchmark::DoNotOptimize(n);
+        benchmark::DoNotOptimize(sections.data());
+    }
+}
+BENCHMARK(butterworth_design_fixed)->ArgNames({"order", "type"})->ArgsProduct({{2, 4, 8, 16, 32}, {0, 1, 2, 3}});
+
+// zpk2sos alone, args: filter order
+void zpk2sos(benchmark::State &state)
+{
+    filter_design::zpk zpk(filter_design::analog_lowpass(static_cast<int>(state.range(0))));
+    zpk = filter_design::lp2bp(zpk, 1.0, 0.5);
+    zpk = filter_design::bilinear_transform(zpk, 2.0);
+    for (auto _ : state)
+    {
+        std::vector<biquad> sections(filter_design::zpk2sos(zpk));
+        benchmark::DoNotOptimize(sections.data());
+    }
+}
+BENCHMARK(zpk2sos)->ArgName("order")->RangeMultiplier(2)->Range(2, 256);
+
+// log statement next to a sample, arg: 0 disabled at runtime, 1 enabled (to a sink that drops the message)
+void log_statement(benchmark::State &state)
+{
+    utils::log_level level = utils::get_log_level();
+    utils::set_log_level(state.range(0) != 0 ? utils::log_level::info : utils::log_level::warning);
+    utils::set_log_sink([](utils::log_level, const std::string &) {});
+    double sample = 0.5;
+    for (auto _ : state)
+    {
+        INFO_STREAM("sample " << sample);
+        benchmark::DoNotOptimize(sample);
+    }
+    utils::set_log_sink(nullptr);
+    utils::set_log_level(level);
+}
+BENCHMARK(log_statement)->ArgName("enabled")->Arg(0)->Arg(1);
+
+BENCHMARK_MAIN();
@@ -1,14 +1,447 @@
 #include "filter_design.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 #include <complex>
 #include <limits>
 #include <algorithm>
 #include <exception>
+#include <stdexcept>
 #include <numeric>    // std::accumulate
 #include <functional> // std::multiplies
+#include <map>
+#include <array>
+#include <iterator>
 #include <assert.h>
 
+namespace
+{
+    /** Zeros to be paired by zpk2sos (real zeros and the zeros with positive imaginary part).
+     *
+     * Equal zeros are grouped (designs have many zeros at the same point), lookups of the nearest zero and
+     * removal take O(log n). Ties are resolved like a scan over the output of cplxpair: real before complex,
+     * smaller (real, imag) first.
+     */
+    class zero_pool
+    {
+    private:
+        std::map<double, std::size_t> m_real;                       // value, count
+        std::map<std::pair<double, double>, std::size_t> m_complex; // (real, imag), count
+
+        template <typename M>
+        static void take(M &m, typename M::iterator it)
+        {
+            if (--it->second == 0)
+            {
+                m.erase(it);
+            }
+        }
+
+        std::map<double, std::size_t>::iterator nearest_real(std::complex<double> to)
+        {
+            auto it = m_real.lower_bound(to.real());
+            if (it == m_real.begin())
+            {
+                return it;
+            }
+            auto before = std::prev(it);
+            if (it == m_real.end() || std::abs(before->first - to) <= std::abs(it->first - to))
+            {
+                return before;
+            }
+            return it;
+        }
+
+        std::map<std::pair<double, double>, std::size_t>::iterator nearest_complex(std::complex<double> to)
+        {
+            auto start = m_complex.lower_bound(std::make_pair(to.real(), -std::numeric_limits<double>::infinity()));
+            auto best = m_complex.end();
+            double best_distance = std::numeric_limits<double>::infinity();
+            auto distance = [to](const std::pair<double, double> &z)
+            { return std::abs(std::complex<double>(z.first, z.second) - to); };
+
+            // scan outwards in the real part until it alone is further away than the best zero
+            for (auto it = start; it != m_complex.end() && it->first.first - to.real() < best_distance; it++)
+            {
+                if (distance(it->first) < best_distance)
+                {
+                    best = it;
+                    best_distance = distance(it->first);
+                }
+            }
+            for (auto it = start; it != m_complex.begin();)
+            {
+                it--;
+                if (to.real() - it->first.first > best_distance)
+                {
+                    break;
+                }
+                // on ties the smaller zero wins
+                if (distance(it->first) <= best_distance)
+                {
+                    best = it;
+                    best_distance = distance(it->first);
+                }
+            }
+            return best;
+        }
+
+    public:
+        explicit zero_pool(const std::vector<std::complex<double>> &zeros)
+        {
+            for (std::complex<double> z : zeros)
+            {
+                if (utils::is_real(z))
+                {
+                    m_real[z.real()]++;
+                }
+                else
+                {
+                    m_complex[std::make_pair(z.real(), z.imag())]++;
+                }
+            }
+        }
+
+        std::complex<double> pop_nearest_real(std::complex<double> to)
+        {
+            if (m_real.empty())
+            {
+                throw std::logic_error("Cannot find real/complex number in array.");
+            }
+            auto it = nearest_real(to);
+            std::complex<double> result(it->first);
+            take(m_real, it);
+            return result;
+        }
+
+        std::complex<double> pop_nearest_complex(std::complex<double> to)
+        {
+            if (m_complex.empty())
+            {
+                throw std::logic_error("Cannot find real/complex number in array.");
+            }
+            auto it = nearest_complex(to);
+            std::complex<double> result(it->first.first, it->first.second);
+            take(m_complex, it);
+            return result;
+        }
+
+        std::complex<double> pop_nearest(std::complex<double> to)
+        {
+            if (m_real.empty())
+            {
+                return pop_nearest_complex(to);
+            }
+            if (m_complex.empty())
+            {
+                return pop_nearest_real(to);
+            }
+            auto complex = nearest_complex(to);
+            bool real = std::abs(nearest_real(to)->first - to) <= std::abs(std::complex<double>(complex->first.first, complex->first.second) - to);
+            return real ? pop_nearest_real(to) : pop_nearest_complex(to);
+        }
+    };
+
+    /** Poles to be paired by zpk2sos (real poles and the poles with positive imaginary part).
+     *
+     * Sorted once by the distance to the unit circle, removed poles are marked (tombstones) and skipped,
+     * the real poles are additionally indexed by value for nearest lookups in O(log n).
+     */
+    class pole_pool
+    {
+    private:
+        std::vector<std::complex<double>> m_poles;     // "worst" (closest to the unit circle) first
+        std::vector<bool> m_removed;
+        std::vector<std::size_t> m_real_order;         // indices of the real poles, "worst" first
+        std::multimap<double, std::size_t> m_real;     // value, index of the real poles not removed
+        std::size_t m_next = 0;
+        std::size_t m_next_real = 0;
+
+        std::complex<double> remove(std::size_t index)
+        {
+            m_removed[index] = true;
+            if (utils::is_real(m_poles[index]))
+            {
+                auto range = m_real.equal_range(m_poles[index].real());
+                for (auto it = range.first; it != range.second; it++)
+                {
+                    if (it->second == index)
+                    {
+                        m_real.erase(it);
+                        break;
+                    }
+                }
+            }
+            return m_poles[index];
+        }
+
+    public:
+        explicit pole_pool(std::vector<std::complex<double>> poles)
+            : m_poles(std::move(poles)), m_removed(m_poles.size(), false)
+        {
+            // sort poles by how close they are to the unit circle
+            std::stable_sort(m_poles.begin(), m_poles.end(), [](std::complex<double> p1, std::complex<double> p2)
+                             { return std::abs(1.0 - std::abs(p1)) < std::abs(1.0 - std::abs(p2)); });
+            for (std::size_t i = 0; i < m_poles.size(); i++)
+            {
+                if (utils::is_real(m_poles[i]))
+                {
+                    m_real_order.push_back(i);
+                    m_real.emplace(m_poles[i].real(), i);
+                }
+            }
+        }
+
+        std::size_t count_real() const { return m_real.size(); }
+
+        std::complex<double> pop_worst()
+        {
+            while (m_removed[m_next])
+            {
+                m_next++;
+            }
+            return remove(m_next);
+        }
+
+        std::complex<double> pop_worst_real()
+        {
+            while (m_removed[m_real_order[m_next_real]])
+            {
+                m_next_real++;
+            }
+            return remove(m_real_order[m_next_real]);
+        }
+
+        std::complex<double> pop_nearest_real(std::complex<double> to)
+        {
+            if (m_real.empty())
+            {
+                throw std::logic_error("Cannot find real/complex number in array.");
+            }
+            auto best = m_real.lower_bound(to.real());
+            if (best != m_real.begin())
+            {
+                // first of the equal values below, on ties the "worse" pole wins
+                auto below = m_real.lower_bound(std::prev(best)->first);
+                if (best == m_real.end() || std::abs(below->first - to) < std::abs(best->first - to) ||
+                    (std::abs(below->first - to) == std::abs(best->first - to) && below->second < best->second))
+                {
+                    best = below;
+                }
+            }
+            return remove(best->second);
+        }
+    };
+
+    /** Zeros, poles and gains of the filters of a bank (see filter_design::design_bank).
+     *
+     * The roots are stored root by root with the bands innermost, so every transform is a loop over
+     * contiguous values of all bands. The expressions are the same as in the single filter transforms,
+     * the results are identical to designing every band on its own.
+     */
+    struct bank_zpk
+    {
+        std::size_t n_bands;
+        std::vector<std::complex<double>> zeros; // [zero][band]
+        std::vector<std::complex<double>> poles; // [pole][band]
+        std::vector<double> gain;                // [band]
+
+        explicit bank_zpk(std::size_t bands) : n_bands(bands), gain(bands, 1.0) {}
+
+        std::size_t n_zeros() const { return zeros.size() / n_bands; }
+        std::size_t n_poles() const { return poles.size() / n_bands; }
+
+        /** Append a root at the same point for all bands. */
+        static void append(std::vector<std::complex<double>> &roots, std::size_t n, std::complex<double> root)
+        {
+            roots.insert(roots.end(), n, root);
+        }
+
+        /** Zeros, poles and gain of a single band. */
+        filter_design::zpk band(std::size_t b) const
+        {
+            filter_design::zpk zpk;
+            for (std::size_t i = b; i < zeros.size(); i += n_bands)
+            {
+                zpk.zeros.push_back(zeros[i]);
+            }
+            for (std::size_t i = b; i < poles.size(); i += n_bands)
+            {
+                zpk.poles.push_back(poles[i]);
+            }
+            zpk.gain = gain[b];
+            return (zpk);
+        }
+    };
+
+    /** Gain compensation of an inversion (see lp2hp and lp2bs), it only depends on the prototype.
+     *
+     * @param prototype analog lowpass prototype
+     * @return gain factor
+     */
+    double inversion_gain(const filter_design::zpk &prototype)
+    {
+        std::complex<double> prod_z(1.0, 1.0);
+        for (auto z : prototype.zeros)
+        {
+            prod_z *= -z;
+        }
+        std::complex<double> prod_p(1.0, 1.0);
+        for (auto p : prototype.poles)
+        {
+            prod_p *= -p;
+        }
+        return (prototype.gain * std::real(prod_z / prod_p));
+    }
+
+    /** Transform the analog lowpass prototype (no zeros) to all bands (see lp2lp, lp2hp, lp2bp and lp2bs).
+     *
+     * @param prototype analog lowpass prototype
+     * @param warped pre-warped critical frequencies [band][frequency]
+     * @param filter_type type of the filters
+     * @return analog filters of all bands
+     */
+    bank_zpk transform_bank(const filter_design::zpk &prototype, const std::vector<std::vector<double>> &warped, filter_design::filter_type filter_type)
+    {
+        std::size_t n_bands = warped.size();
+        std::size_t degree = prototype.poles.size();
+        bank_zpk bank(n_bands);
+
+        // band parameters in contiguous arrays (cutoff, or center and half width)
+        std::vector<double> center(n_bands);
+        std::vector<double> width(n_bands);
+        for (std::size_t b = 0; b < n_bands; b++)
+        {
+            center[b] = (warped[b].size() == 1) ? warped[b][0] : std::sqrt(warped[b][0] * warped[b][1]);
+            width[b] = (warped[b].size() == 1) ? 0 : std::abs(warped[b][1] - warped[b][0]);
+        }
+
+        switch (filter_type)
+        {
+        case filter_design::filter_type::lowpass:
+        {
+            bank.poles.resize(degree * n_bands);
+            for (std::size_t k = 0; k < degree; k++)
+            {
+                std::complex<double> *poles = &bank.poles[k * n_bands];
+                for (std::size_t b = 0; b < n_bands; b++)
+                {
+                    poles[b] = center[b] * prototype.poles[k];
+                }
+            }
+            for (std::size_t b = 0; b < n_bands; b++)
+            {
+                bank.gain[b] = prototype.gain * pow(center[b], degree);
+            }
+            break;
+        }
+        case filter_design::filter_type::highpass:
+        {
+            bank.poles.resize(degree * n_bands);
+            for (std::size_t k = 0; k < degree; k++)
+            {
+                std::complex<double> *poles = &bank.poles[k * n_bands];
+                for (std::size_t b = 0; b < n_bands; b++)
+                {
+                    poles[b] = center[b] / prototype.poles[k];
+                }
+            }
+            bank_zpk::append(bank.zeros, degree * n_bands, 0);
+            bank.gain.assign(n_bands, inversion_gain(prototype));
+            break;
+        }
+        case filter_design::filter_type::bandpass:
+        case filter_design::filter_type::bandstop:
+        {
+            bool bandpass = filter_type == filter_design::filter_type::bandpass;
+            bank.poles.resize(2 * degree * n_bands);
+            for (std::size_t k = 0; k < degree; k++)
+            {
+                // shifted to +wo (first half) and -wo (second half), same order as lp2bp and lp2bs
+                std::complex<double> *plus = &bank.poles[k * n_bands];
+                std::complex<double> *minus = &bank.poles[(degree + k) * n_bands];
+                for (std::size_t b = 0; b < n_bands; b++)
+                {
+                    std::complex<double> p = prototype.poles[k];
+                    if (bandpass)
+                    {
+                        p *= width[b] / 2;
+                    }
+                    else
+                    {
+                        p = (width[b] / 2) / p;
+                    }
+                    std::complex<double> shift = std::sqrt(std::pow(p, 2) - std::pow(center[b], 2));
+                    plus[b] = p + shift;
+                    minus[b] = p - shift;
+                }
+            }
+            if (bandpass)
+            {
+                bank_zpk::append(bank.zeros, degree * n_bands, 0);
+                for (std::size_t b = 0; b < n_bands; b++)
+                {
+                    bank.gain[b] = prototype.gain * std::pow(width[b], degree);
+                }
+            }
+            else
+            {
+                // zeros at the center of the stopband
+                bank.zeros.resize(2 * degree * n_bands);
+                for (std::size_t k = 0; k < degree; k++)
+                {
+                    for (std::size_t b = 0; b < n_bands; b++)
+                    {
+                        bank.zeros[k * n_bands + b] = std::complex<double>(0, center[b]);
+                        bank.zeros[(degree + k) * n_bands + b] = std::complex<double>(0, -center[b]);
+                    }
+                }
+                bank.gain.assign(n_bands, inversion_gain(prototype));
+            }
+            break;
+        }
+        default:
+            throw std::invalid_argument("Filtertype not implemented!");
+        }
+
+        return (bank);
+    }
+
+    /** Bilinear transform of all bands (see bilinear_transform).
+     *
+     * @param bank analog filters of all bands
+     * @param sampling_frequency sample rate
+     */
+    void bilinear_transform_bank(bank_zpk &bank, double sampling_frequency)
+    {
+        std::size_t n_bands = bank.n_bands;
+        std::size_t degree = bank.n_poles() - bank.n_zeros();
+
+        // Compensate for gain change (products in the order of the roots of every band)
+        std::vector<std::complex<double>> prod_z(n_bands, std::complex<double>(1.0, 1.0));
+        std::vector<std::complex<double>> prod_p(n_bands, std::complex<double>(1.0, 1.0));
+        for (std::size_t i = 0; i < bank.zeros.size(); i++)
+        {
+            std::complex<double> z = bank.zeros[i];
+            prod_z[i % n_bands] *= 2.0 * sampling_frequency - z;
+            bank.zeros[i] = (2.0 * sampling_frequency + z) / (2.0 * sampling_frequency - z);
+        }
+        for (std::size_t i = 0; i < bank.poles.size(); i++)
+        {
+            std::complex<double> p = bank.poles[i];
+            prod_p[i % n_bands] *= 2.0 * sampling_frequency - p;
+            bank.poles[i] = (2.0 * sampling_frequency + p) / (2.0 * sampling_frequency - p);
+        }
+        for (std::size_t b = 0; b < n_bands; b++)
+        {
+            bank.gain[b] = bank.gain[b] * std::real(prod_z[b] / prod_p[b]);
+        }
+
+        // Any zeros that were at infinity get moved to the Nyquist frequency
+        bank_zpk::append(bank.zeros, degree * n_bands, -1);
+    }
+} // namespace
+
 filter_design::zpk filter_design::analog_lowpass(int filter_order)
 {
     filter_design::zpk zpk;
@@ -251,16 +684,15 @@ std::pair<std::vector<std::complex<double>>, std::vector<std::complex<double>>>
         throw std::invalid_argument("Array contains complex value with no matching conjugate");
     }
 
-    for (int i = 0; i < z_ip.size(); i++)
+    // z_in is sorted by real part, only its values with a real part within tol can match
+    for (std::complex<double> number : z_ip)
     {
+        auto it = std::lower_bound(z_in.begin(), z_in.end(), number.real() - tol, [](const std::complex<double> &a, double real)
+                                   { return a.real() < real; });
         bool found = false;
-        for (int j = 0; j < z_in.size(); j++)
+        for (; it != z_in.end() && it->real() <= number.real() + tol && !found; it++)
         {
-            if (std::abs(z_ip.at(i) - std::conj(z_in.at(j))) < tol)
-            {
-                found = true;
-                break;
-            }
+            found = std::abs(number - std::conj(*it)) < tol;
         }
         if (!found)
         {
@@ -300,11 +732,11 @@ biquad filter_design::zpk2tf(filter_design::zpk zpk_sos)
 std::vector<biquad> filter_design::zpk2sos(filter_design::zpk zpk)
 {
     // ensure we have the same number of poles and zeros
-    for (int i = 0; i < zpk.zeros.size() - zpk.poles.size(); i++)
+    while (zpk.poles.size() < zpk.zeros.size())
     {
         zpk.poles.push_back(0);
     }
-    for (int i = 0; i < zpk.poles.size() - zpk.zeros.size(); i++)
+    while (zpk.zeros.size() < zpk.poles.size())
     {
         zpk.zeros.push_back(0);
     }
@@ -322,118 +754,212 @@ std::vector<biquad> filter_design::zpk2sos(filter_design::zpk zpk)
     // positive imaginary part):
     auto poles_r_i = cplxpair(zpk.poles);
     std::vector<std::complex<double>> poles(poles_r_i.first);
-    for (std::complex<double> p : poles_r_i.second)
-    {
-        poles.push_back(p);
-    }
+    poles.insert(poles.end(), poles_r_i.second.begin(), poles_r_i.second.end());
     auto zeros_r_i = cplxpair(zpk.zeros);
     std::vector<std::complex<double>> zeros(zeros_r_i.first);
-    for (std::complex<double> z : zeros_r_i.second)
-    {
-        zeros.push_back(z);
-    }
+    zeros.insert(zeros.end(), zeros_r_i.second.begin(), zeros_r_i.second.end());
 
-    // sort poles by how close they are to the unit circle
-    sort(poles.begin(), poles.end(), [](std::complex<double> p1, std::complex<double> p2) -> double
-         { return (std::abs(1.0 - std::abs(p1)) < std::abs(1.0 - std::abs(p2))); });
+    // sorted once, removed by index (like scipy), nearest lookups in O(log n)
+    pole_pool pole_pool(std::move(poles));
+    zero_pool zero_pool(zeros);
 
-    std::vector<std::vector<std::complex<double>>> poles_sos;
-    std::vector<std::vector<std::complex<double>>> zeros_sos;
+    std::vector<std::array<std::complex<double>, 2>> poles_sos;
+    std::vector<std::array<std::complex<double>, 2>> zeros_sos;
     for (int s = 0; s < n_sections; s++)
     {
         std::complex<double> p1, p2, z1, z2;
 
         // Select the next "worst" pole (closes to unit cycle)
-        p1 = poles.front();
-        poles.erase(poles.begin());
+        p1 = pole_pool.pop_worst();
 
         // Pair that pole with a zero
-
-        std::vector<bool> poles_real(utils::is_real(poles));
-        if (utils::is_real(p1) && std::accumulate(poles_real.begin(), poles_real.end(), 0) == 0)
+        if (utils::is_real(p1) && pole_pool.count_real() == 0)
         {
             // Special case to set a first-order section
-            z1 = utils::pop_nearest_real_complex(zeros, p1, true);
+            z1 = zero_pool.pop_nearest_real(p1);
             p2 = std::complex<double>(0, 0);
             z2 = std::complex<double>(0, 0);
         }
         else
         {
-            if (!utils::is_real(p1) && std::accumulate(poles_real.begin(), poles_real.end(), 0) == 1)
+            if (!utils::is_real(p1) && pole_pool.count_real() == 1)
             {
                 // Special case to ensure we choose a complex zero to pair
                 // with so later (setting up a first-order section)
-                z1 = utils::pop_nearest_real_complex(zeros, p1, false);
-                assert(!utils::is_real(z1));
+                z1 = zero_pool.pop_nearest_complex(p1);
             }
             else
             {
                 // Pair the pole with the closest zero (real or complex)
-                int z1_idx = std::distance(
-                    zeros.begin(),
-                    std::min_element(zeros.begin(),
-                                     zeros.end(),
-                                     [p1](std::complex<double> zi, std::complex<double> zj)
-                                     {
-                                         return (std::abs(p1 - zi) < std::abs(p1 - zj));
-                                     }));
-                z1 = zeros.at(z1_idx);
-                zeros.erase(zeros.begin() + z1_idx);
+                z1 = zero_pool.pop_nearest(p1);
             }
 
             // Now that we have p1 and z1, figure out what p2 and z2 need to be
             if (!utils::is_real(p1))
             {
-                if (!utils::is_real(z1))
-                {
-                    // complex pole, complex zero
-                    p2 = std::conj(p1);
-                    z2 = std::conj(z1);
-                }
-                else
-                {
-                    // complex pole, real zero
-                    p2 = std::conj(p1);
-                    z2 = utils::pop_nearest_real_complex(zeros, p1, true);
-                    assert(utils::is_real(z2));
-                }
+                // complex pole, complex or real zero
+                p2 = std::conj(p1);
+                z2 = utils::is_real(z1) ? zero_pool.pop_nearest_real(p1) : std::conj(z1);
+            }
+            else if (!utils::is_real(z1))
+            {
+                // real pole, complex zero
+                z2 = std::conj(z1);
+                p2 = pole_pool.pop_nearest_real(z1);
             }
             else
             {
-                if (!utils::is_real(z1))
-                {
-                    // real pole, complex zero
-                    z2 = std::conj(z1);
-                    p2 = utils::pop_nearest_real_complex(poles, z1, true);
-                    assert(utils::is_real(p2));
-                }
-                else
-                {
-                    // real pole, real zero
-                    // pick the next "worst" pole to use
-                    auto p2_idx = std::find_if(poles.begin(), poles.end(), [](std::complex<double> pi)
-                                               { return (utils::is_real(pi)); });
-                    p2 = *p2_idx;
-                    assert(utils::is_real(p2));
-                    poles.erase(p2_idx);
-                    // find a real zero to match the added pole
-                    z2 = utils::pop_nearest_real_complex(zeros, p2, true);
-                    assert(utils::is_real(z2));
-                }
+                // real pole, real zero
+                // pick the next "worst" pole to use
+                p2 = pole_pool.pop_worst_real();
+                // find a real zero to match the added pole
+                z2 = zero_pool.pop_nearest_real(p2);
             }
         }
-        poles_sos.push_back(std::vector<std::complex<double>>{p1, p2});
-        zeros_sos.push_back(std::vector<std::complex<double>>{z1, z2});
+        poles_sos.push_back({p1, p2});
+        zeros_sos.push_back({z1, z2});
     }
-    assert(poles.size() == 0 && zeros.size() == 0);
 
     // Construct the system, reversing order so the "worst" are last
     std::vector<biquad> sos;
     for (int s = n_sections - 1; s >= 0; s--)
     {
         double gain = (s == n_sections - 1) ? zpk.gain : 1;
-        sos.push_back(zpk2tf(filter_design::zpk{zeros_sos.at(s), poles_sos.at(s), gain}));
+        sos.push_back(zpk2tf(filter_design::zpk{{zeros_sos[s].begin(), zeros_sos[s].end()}, {poles_sos[s].begin(), poles_sos[s].end()}, gain}));
     }
 
     return (sos);
 }
+
+std::vector<biquad> filter_design::butter(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency)
+{
+    std::vector<double> Wn;
+
+    for (double f : freq)
+    {
+        Wn.push_back(2 * f / sampling_frequency);
+        if (Wn.back() <= 0 || Wn.back() >= 1)
+        {
+            throw std::invalid_argument("Digital filter critical frequencies in freq must be 0 < f < fs/2");
+        }
+    }
+
+    // Get analog lowpass prototype
+    filter_design::zpk zpk(analog_lowpass(filter_order));
+
+    // Pre-warp frequencies for digital filter design
+    double fs = 2.0;
+    std::vector<double> warped;
+    for (double w : Wn)
+    {
+        warped.push_back(2 * fs * tan(PI * w / fs));
+    }
+    if (warped.size() != 1 &&
+        (filter_type == filter_design::filter_type::lowpass ||
+         filter_type == filter_design::filter_type::highpass))
+    {
+        throw std::invalid_argument("Must specify a single critical frequency for lowpass or highpass filter");
+    }
+    if (warped.size() != 2 &&
+        (filter_type == filter_design::filter_type::bandpass ||
+         filter_type == filter_design::filter_type::bandstop))
+    {
+        throw std::invalid_argument("Must specify two critical frequencies for bandpass or bandstop filter");
+    }
+
+    // transform to lowpass, bandpass, highpass, or bandstop
+    switch (filter_type)
+    {
+    case filter_design::filter_type::lowpass:
+    {
+        zpk = lp2lp(zpk, warped.at(0));
+        break;
+    }
+    case filter_design::filter_type::highpass:
+    {
+        zpk = lp2hp(zpk, warped.at(0));
+        break;
+    }
+    case filter_design::filter_type::bandpass:
+    {
+        double passband_center = std::sqrt(warped.at(0) * warped.at(1));
+        double passband_width = std::abs(warped.at(1) - warped.at(0));
+        zpk = lp2bp(zpk, passband_center, passband_width);
+        break;
+    }
+    case filter_design::filter_type::bandstop:
+    {
+        double stopband_center = std::sqrt(warped.at(0) * warped.at(1));
+        double stopband_width = std::abs(warped.at(1) - warped.at(0));
+        zpk = lp2bs(zpk, stopband_center, stopband_width);
+        break;
+    }
+    default:
+        throw std::invalid_argument("Filtertype not implemented!");
+    }
+
+    zpk = bilinear_transform(zpk, fs);
+
+    return (zpk2sos(zpk));
+}
+
+filter_design::bank filter_design::design_bank(int filter_order, const std::vector<std::vector<double>> &bands, filter_design::filter_type filter_type,
+                                               double sampling_frequency, thread_pool *pool)
+{
+    if (bands.empty())
+    {
+        throw std::invalid_argument("Filter bank needs at least one band");
+    }
+
+    // Pre-warp frequencies for digital filter design (same checks as butter)
+    double fs = 2.0;
+    std::vector<std::vector<double>> warped;
+    for (const std::vector<double> &freq : bands)
+    {
+        warped.emplace_back();
+        for (double f : freq)
+        {
+            double w = 2 * f / sampling_frequency;
+            if (w <= 0 || w >= 1)
+            {
+                throw std::invalid_argument("Digital filter critical frequencies in freq must be 0 < f < fs/2");
+            }
+            warped.back().push_back(2 * fs * tan(PI * w / fs));
+        }
+        if (warped.back().size() != 1 &&
+            (filter_type == filter_design::filter_type::lowpass ||
+             filter_type == filter_design::filter_type::highpass))
+        {
+            throw std::invalid_argument("Must specify a single critical frequency for lowpass or highpass filter");
+        }
+        if (warped.back().size() != 2 &&
+            (filter_type == filter_design::filter_type::bandpass ||
+             filter_type == filter_design::filter_type::bandstop))
+        {
+            throw std::invalid_argument("Must specify two critical frequencies for bandpass or bandstop filter");
+        }
+    }
+
+    // the prototype is shared by all bands
+    bank_zpk digital(transform_bank(analog_lowpass(filter_order), warped, filter_type));
+    bilinear_transform_bank(digital, fs);
+
+    filter_design::bank result{bands, std::vector<std::vector<biquad>>(bands.size()), sampling_frequency};
+    auto pair = [&](std::size_t b)
+    {
+        result.sections[b] = zpk2sos(digital.band(b));
+    };
+    if (pool != nullptr)
+    {
+        pool->run(bands.size(), pair);
+    }
+    else
+    {
+        for (std::size_t b = 0; b < bands.size(); b++)
+        {
+            pair(b);
+        }
+    }
+
+    return (result);
+}
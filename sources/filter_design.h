@@ -5,6 +5,8 @@
 #include <complex>
 #include "biquad.h"
 
+class thread_pool;
+
 namespace filter_design
 {
     enum class filter_type
@@ -180,6 +182,44 @@ namespace filter_design
      *      with the ``pairing == 'keep_odd'`` method.
      */
     std::vector<biquad> zpk2sos(filter_design::zpk zpk);
+
+    /** Butterworth digital filter design in second order sections (like scipy.signal.butter with output='sos').
+     *
+     * Allocates, see static_design::butter for a design on fixed capacity storage (real-time threads).
+     *
+     * @param filter_order The order of the filter.
+     * @param freq The critical frequency or frequencies (one for lowpass and highpass, two for bandpass and
+     *             bandstop filters, in the same units as `sampling_frequency`).
+     * @param filter_type The type of filter.
+     * @param sampling_frequency The sampling frequency of the digital system.
+     * @return Vector of biquads (second order sections)
+     */
+    std::vector<biquad> butter(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency);
+
+    /** Butterworth filters of a bank (same order and type, one filter per band), see design_bank. */
+    struct bank
+    {
+        std::vector<std::vector<double>> bands{};    // critical frequencies of every band
+        std::vector<std::vector<biquad>> sections{}; // second order sections of every band
+        double sampling_frequency = 0;
+    };
+
+    /** Butterworth digital filter design of a whole filter bank (e.g. 1/3-octave or mel bands).
+     *
+     * The analog prototype is designed once and the frequency and bilinear transforms run over all bands at
+     * once (roots stored band by band in contiguous arrays), only the pairing in zpk2sos is done per band.
+     * The sections of every band are the same as returned by butter for that band.
+     *
+     * @param filter_order The order of the filters.
+     * @param bands The critical frequency or frequencies of every band (see butter), throws
+     *              std::invalid_argument if empty.
+     * @param filter_type The type of the filters.
+     * @param sampling_frequency The sampling frequency of the digital system.
+     * @param pool Optional thread pool, the bands are paired in parallel.
+     * @return second order sections of all bands
+     */
+    filter_design::bank design_bank(int filter_order, const std::vector<std::vector<double>> &bands, filter_design::filter_type filter_type,
+                                    double sampling_frequency, thread_pool *pool = nullptr);
 };
 
 #endif //!__FILTER_DESIGN__H__
\ No newline at end of file
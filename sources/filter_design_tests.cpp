@@ -1,4 +1,7 @@
+#include <cmath>
+
 #include "filter_design.h"
+#include "thread_pool.h"
 
 #include "gtest/gtest.h"
 
@@ -341,3 +344,77 @@ TEST(filter_design_test, zpk2sos)
     EXPECT_NEAR(coefficients1.at(3), -1.60000000, EPSILON);
     EXPECT_NEAR(coefficients1.at(4), +0.65000000, EPSILON);
 }
+
+TEST(filter_design_test, zpk2sos_pairing)
+{
+    // Reference values generated with
+    // signal.butter(5, [0.3, 4.0], 'bs', fs=50, output='sos')
+    // (real poles paired with complex zeros, the remaining poles keep their order)
+
+    std::vector<biquad> result(filter_design::butter(5, std::vector<double>{0.3, 4.0}, filter_design::filter_type::bandstop, 50));
+    std::vector<std::vector<double>> expected{{0.46727339, -0.92554335, 0.46727339, -1.34213363, 0.4977666},
+                                              {1.0, -1.980732, 1.0, -1.55747952, 0.77229147},
+                                              {1.0, -1.980732, 1.0, -1.60155104, 0.61713048},
+                                              {1.0, -1.980732, 1.0, -1.93778073, 0.93943829},
+                                              {1.0, -1.980732, 1.0, -1.97825473, 0.97969212}};
+
+    const double EPSILON = 1.0e-8;
+
+    ASSERT_EQ(expected.size(), result.size());
+    for (std::size_t s = 0; s < expected.size(); s++)
+    {
+        std::vector<double> coefficients(result[s].get_coefficients());
+        for (std::size_t i = 0; i < 5; i++)
+        {
+            EXPECT_NEAR(expected[s][i], coefficients[i], EPSILON);
+        }
+    }
+}
+
+TEST(filter_design_test, design_bank)
+{
+    // 1/3-octave bands from 25 Hz to 16 kHz
+    std::vector<std::vector<double>> third_octaves;
+    for (int i = -16; i <= 12; i++)
+    {
+        double center = 1000 * std::pow(2.0, i / 3.0);
+        third_octaves.push_back({center * std::pow(2.0, -1 / 6.0), center * std::pow(2.0, 1 / 6.0)});
+    }
+    std::vector<std::vector<double>> cutoffs{{0.5}, {100}, {1000}, {20000}};
+
+    thread_pool pool(4);
+    for (filter_design::filter_type filter_type : {filter_design::filter_type::lowpass, filter_design::filter_type::highpass,
+                                                   filter_design::filter_type::bandpass, filter_design::filter_type::bandstop})
+    {
+        bool band = filter_type == filter_design::filter_type::bandpass || filter_type == filter_design::filter_type::bandstop;
+        const std::vector<std::vector<double>> &bands = band ? third_octaves : cutoffs;
+        for (int order : {1, 4, 7})
+        {
+            SCOPED_TRACE(testing::Message() << "order " << order << ", type " << static_cast<int>(filter_type));
+            filter_design::bank result(filter_design::design_bank(order, bands, filter_type, 48000));
+            filter_design::bank parallel(filter_design::design_bank(order, bands, filter_type, 48000, &pool));
+            EXPECT_EQ(bands, result.bands);
+            EXPECT_EQ(48000, result.sampling_frequency);
+            ASSERT_EQ(bands.size(), result.sections.size());
+            ASSERT_EQ(bands.size(), parallel.sections.size());
+
+            // identical to the design of the single filters
+            for (std::size_t b = 0; b < bands.size(); b++)
+            {
+                std::vector<biquad> expected(filter_design::butter(order, bands[b], filter_type, 48000));
+                ASSERT_EQ(expected.size(), result.sections[b].size());
+                ASSERT_EQ(expected.size(), parallel.sections[b].size());
+                for (std::size_t s = 0; s < expected.size(); s++)
+                {
+                    EXPECT_EQ(expected[s].get_coefficients(), result.sections[b][s].get_coefficients());
+                    EXPECT_EQ(expected[s].get_coefficients(), parallel.sections[b][s].get_coefficients());
+                }
+            }
+        }
+    }
+
+    EXPECT_THROW(filter_design::design_bank(4, {}, filter_design::filter_type::bandpass, 48000), std::invalid_argument);
+    EXPECT_THROW(filter_design::design_bank(4, {{100, 200}, {100}}, filter_design::filter_type::bandpass, 48000), std::invalid_argument);
+    EXPECT_THROW(filter_design::design_bank(4, {{100}, {100, 200}}, filter_design::filter_type::lowpass, 48000), std::invalid_argument);
+    EXPECT_THROW(filter_design::design_bank(4, {{100, 200}, {100, 24000}}, filter_design::filter_type::bandpass, 48000), std::invalid_argument);
+}
@@ -0,0 +1,196 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "file_filter.h"
+
+namespace
+{
+    void usage()
+    {
+        std::cerr << "Usage: filterlib-run [options] <input> <output>\n"
+                     "Filter a recording (interleaved channels) with a Butterworth filter.\n"
+                     "Files ending in .wav or .npy are streamed with the format and channels of their header,\n"
+                     "other files are raw samples, mapped into memory. Output '-' writes raw samples to the standard output.\n\n"
+                     "Options:\n"
+                     "  --format s16|s32|f32|f64   sample format of raw files (default f64, or the input format)\n"
+                     "  --channels N               interleaved channels of raw files (default 1)\n"
+                     "  --order N                  filter order (default 4)\n"
+                     "  --type T                   lowpass, highpass, bandpass or bandstop (default lowpass)\n"
+                     "  --freq F[,F2]              critical frequency or frequencies (required)\n"
+                     "  --fs F                     sampling frequency (default: from a WAV input, else 2, freq relative to Nyquist)\n"
+                     "  --tile N                   frames per tile (default: fits the cache)\n"
+                     "  --stream                   write the output with write calls instead of a mapping\n";
+    }
+
+    filter_design::filter_type parse_filter_type(const std::string &name)
+    {
+        if (name == "lowpass")
+        {
+            return filter_design::filter_type::lowpass;
+        }
+        if (name == "highpass")
+        {
+            return filter_design::filter_type::highpass;
+        }
+        if (name == "bandpass")
+        {
+            return filter_design::filter_type::bandpass;
+        }
+        if (name == "bandstop")
+        {
+            return filter_design::filter_type::bandstop;
+        }
+        throw std::invalid_argument("Unknown filter type '" + name + "'");
+    }
+
+    std::vector<double> parse_frequencies(const std::string &list)
+    {
+        std::vector<double> freq;
+        std::size_t start = 0;
+        while (start <= list.size())
+        {
+            std::size_t end = list.find(',', start);
+            if (end == std::string::npos)
+            {
+                end = list.size();
+            }
+            freq.push_back(std::stod(list.substr(start, end - start)));
+            start = end + 1;
+        }
+        return freq;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    sample_format format = sample_format::float64;
+    bool has_format = false;
+    std::size_t channels = 1;
+    int order = 4;
+    filter_design::filter_type type = filter_design::filter_type::lowpass;
+    std::vector<double> freq;
+    double sampling_frequency = 0;
+    std::size_t tile_frames = 0;
+    bool map_output = true;
+    std::vector<std::string> paths;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg(argv[i]);
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "-h" || arg == "--help")
+            {
+                usage();
+                return EXIT_SUCCESS;
+            }
+            else if (arg == "--format")
+            {
+                format = parse_sample_format(value());
+                has_format = true;
+            }
+            else if (arg == "--channels")
+            {
+                channels = std::stoul(value());
+            }
+            else if (arg == "--order")
+            {
+                order = std::stoi(value());
+            }
+            else if (arg == "--type")
+            {
+                type = parse_filter_type(value());
+            }
+            else if (arg == "--freq")
+            {
+                freq = parse_frequencies(value());
+            }
+            else if (arg == "--fs")
+            {
+                sampling_frequency = std::stod(value());
+            }
+            else if (arg == "--tile")
+            {
+                tile_frames = std::stoul(value());
+            }
+            else if (arg == "--stream")
+            {
+                map_output = false;
+            }
+            else if (arg.size() > 1 && arg[0] == '-')
+            {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+            else
+            {
+                paths.push_back(arg);
+            }
+        }
+        if (paths.size() != 2 || freq.empty())
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        file_type input_type = get_file_type(paths[0]);
+        file_type output_type = paths[1] == "-" ? file_type::raw : get_file_type(paths[1]);
+        std::size_t frames = 0;
+        double seconds = 0;
+        double megabytes = 0;
+        if (input_type == file_type::raw && output_type == file_type::raw)
+        {
+            file_filter filter(order, freq, type, sampling_frequency > 0 ? sampling_frequency : 2, channels, format, tile_frames);
+            auto start = std::chrono::steady_clock::now();
+            frames = filter.process_file(paths[0], paths[1], map_output);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            megabytes = 1.0e-6 * static_cast<double>(frames * filter.get_frame_size());
+        }
+        else
+        {
+            // streamed through reader and writer, the output keeps the input format unless given
+            sample_reader reader(paths[0], input_type, format, channels);
+            if (paths[1] != "-" && is_same_file(paths[0], paths[1]))
+            {
+                throw std::invalid_argument("Input and output are the same file '" + paths[1] + "'");
+            }
+            if (sampling_frequency <= 0)
+            {
+                sampling_frequency = reader.get_sampling_frequency() > 0 ? reader.get_sampling_frequency() : 2;
+            }
+            sample_format output_format = has_format ? format : reader.get_format();
+            sample_writer writer(paths[1], output_type, output_format, reader.get_channels(), sampling_frequency);
+            file_filter filter(order, freq, type, sampling_frequency, reader.get_channels(), output_format, tile_frames);
+            auto start = std::chrono::steady_clock::now();
+            frames = filter.process(reader, writer);
+            writer.close();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            megabytes = 1.0e-6 * static_cast<double>(frames * reader.get_channels() * get_sample_size(reader.get_format()));
+        }
+
+        std::cerr << frames << " frames (" << megabytes << " MB) in " << seconds << " s";
+        if (seconds > 0)
+        {
+            std::cerr << ", " << megabytes / seconds << " MB/s";
+        }
+        std::cerr << "\n";
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "filterlib-run: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+#include "multichannel_butterworth.h"
+#include "butterworth.h"
+#include "simd_dispatch.h"
+
+#include <algorithm>
+
+template <typename T>
+basic_multichannel_butterworth<T>::basic_multichannel_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                                                                  std::size_t n_channels)
+    : m_kernels(&simd::get_kernels()),
+      m_kernel(&m_kernels->get<T>()),
+      m_n_channels(n_channels),
+      m_n_padded_channels((n_channels + m_kernel->lanes - 1) / m_kernel->lanes * m_kernel->lanes),
+      m_sections(basic_butterworth<T>(filter_order, freq, filter_type, sampling_frequency).get_sections())
+{
+    for (basic_biquad<T> &section : m_sections)
+    {
+        std::vector<T> coefficients(section.get_coefficients());
+        m_coefficients.insert(m_coefficients.end(), coefficients.begin(), coefficients.end());
+    }
+    m_state.assign(2 * m_sections.size() * m_n_padded_channels, T(0));
+}
+
+template <typename T>
+basic_multichannel_butterworth<T>::~basic_multichannel_butterworth()
+{
+}
+
+template <typename T>
+std::size_t basic_multichannel_butterworth<T>::get_lanes()
+{
+    return m_kernel->lanes;
+}
+
+template <typename T>
+simd::instruction_set basic_multichannel_butterworth<T>::get_instruction_set()
+{
+    return m_kernels->isa;
+}
+
+template <typename T>
+template <typename Gather, typename Scatter>
+void basic_multichannel_butterworth<T>::process_tiles(const T *in, T *out, std::size_t in_stride, std::size_t out_stride,
+                                                      std::size_t n_samples, Gather gather, Scatter scatter)
+{
+    const std::size_t lanes = m_kernel->lanes;
+    alignas(64) T buffer[simd::TILE_SIZE * simd::MAX_LANE_BYTES / sizeof(T)];
+
+    for (std::size_t tile = 0; tile < n_samples; tile += simd::TILE_SIZE)
+    {
+        std::size_t tile_size = std::min(simd::TILE_SIZE, n_samples - tile);
+        for (std::size_t channel = 0; channel < m_n_channels; channel += lanes)
+        {
+            std::size_t n_lanes = std::min(lanes, m_n_channels - channel);
+            T *state = m_state.data() + channel;
+            if (in != nullptr && n_lanes == lanes)
+            {
+                // full channel group of strided input: the kernel reads and writes the samples directly
+                m_kernel->process(m_coefficients.data(), m_sections.size(), state, m_n_padded_channels,
+                                  in + tile * in_stride + channel, in_stride,
+                                  out + tile * out_stride + channel, out_stride, tile_size);
+                continue;
+            }
+
+            // copy the channels into the buffer, padding lanes stay at zero
+            std::fill(buffer, buffer + tile_size * lanes, T(0));
+            gather(buffer, lanes, tile, tile_size, channel, n_lanes);
+            m_kernel->process(m_coefficients.data(), m_sections.size(), state, m_n_padded_channels,
+                              buffer, lanes, buffer, lanes, tile_size);
+            scatter(buffer, lanes, tile, tile_size, channel, n_lanes);
+        }
+    }
+}
+
+template <typename T>
+void basic_multichannel_butterworth<T>::process_interleaved(const T *in, T *out, std::size_t n_frames)
+{
+    const std::size_t n_channels = m_n_channels;
+    process_tiles(
+        in, out, n_channels, n_channels, n_frames,
+        [in, n_channels](T *buffer, std::size_t lanes, std::size_t tile, std::size_t tile_size, std::size_t channel, std::size_t n_lanes)
+        {
+            for (std::size_t i = 0; i < tile_size; i++)
+            {
+                const T *frame = in + (tile + i) * n_channels + channel;
+                std::copy(frame, frame + n_lanes, buffer + i * lanes);
+            }
+        },
+        [out, n_channels](const T *buffer, std::size_t lanes, std::size_t tile, std::size_t tile_size, std::size_t channel, std::size_t n_lanes)
+        {
+            for (std::size_t i = 0; i < tile_size; i++)
+            {
+                std::copy(buffer + i * lanes, buffer + i * lanes + n_lanes, out + (tile + i) * n_channels + channel);
+            }
+        });
+}
+
+template <typename T>
+void basic_multichannel_butterworth<T>::process_planar(const T *const *in, T *const *out, std::size_t n_samples)
+{
+    // planar channels are not strided in memory, always go through the buffer
+    process_tiles(
+        nullptr, nullptr, 0, 0, n_samples,
+        [in](T *buffer, std::size_t lanes, std::size_t tile, std::size_t tile_size, std::size_t channel, std::size_t n_lanes)
+        {
+            for (std::size_t l = 0; l < n_lanes; l++)
+            {
+                const T *samples = in[channel + l] + tile;
+                for (std::size_t i = 0; i < tile_size; i++)
+                {
+                    buffer[i * lanes + l] = samples[i];
+                }
+            }
+        },
+        [out](const T *buffer, std::size_t lanes, std::size_t tile, std::size_t tile_size, std::size_t channel, std::size_t n_lanes)
+        {
+            for (std::size_t l = 0; l < n_lanes; l++)
+            {
+                T *samples = out[channel + l] + tile;
+                for (std::size_t i = 0; i < tile_size; i++)
+                {
+                    samples[i] = buffer[i * lanes + l];
+                }
+            }
+        });
+}
+
+template class basic_multichannel_butterworth<double>;
+template class basic_multichannel_butterworth<float>;
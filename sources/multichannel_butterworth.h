@@ -0,0 +1,105 @@
+#ifndef __MULTICHANNEL_BUTTERWORTH__H__
+#define __MULTICHANNEL_BUTTERWORTH__H__
+
+#include <vector>
+#include <cstddef>
+#include "biquad.h"
+#include "filter_design.h"
+#include "simd_dispatch.h"
+
+/** Butterworth filter applied to many channels at once.
+ *
+ * @tparam T sample, coefficient and state type (explicitly instantiated for float and double,
+ *           float doubles the number of lanes)
+ *
+ * All channels share the same design. The coefficients are stored once and the state of all channels
+ * is stored as structure of arrays (per section and state word one contiguous array over the channels),
+ * so the cascade is evaluated for a group of channels in the lanes of SIMD registers.
+ * The sections are realized in transposed direct form 2. The kernels of the instruction set
+ * selected by simd::get_kernels() at construction are used for the lifetime of the filter.
+ */
+template <typename T>
+class basic_multichannel_butterworth
+{
+private:
+    const simd::kernels *m_kernels;      // kernels selected at construction
+    const simd::lane_kernel<T> *m_kernel; // kernel for the sample type
+    std::size_t m_n_channels;
+    std::size_t m_n_padded_channels; // channels rounded up to a multiple of the lane count
+    std::vector<basic_biquad<T>> m_sections;
+    std::vector<T> m_coefficients; // b0, b1, b2, a1, a2 per section
+    std::vector<T> m_state;        // [section][s1, s2][padded channel]
+
+    template <typename Gather, typename Scatter>
+    void process_tiles(const T *in, T *out, std::size_t in_stride, std::size_t out_stride,
+                       std::size_t n_samples, Gather gather, Scatter scatter);
+
+public:
+    /** Butterworth digital filter design for multiple channels.
+     *
+     * @param filter_order The order of the filter.
+     * @param freq The critical frequency or frequencies (see butterworth).
+     * @param filter_type The type of filter.
+     * @param sampling_frequency The sampling frequency of the digital system.
+     * @param n_channels The number of channels filtered with the same design.
+     */
+    basic_multichannel_butterworth(int filter_order, std::vector<double> freq, filter_design::filter_type filter_type, double sampling_frequency,
+                                   std::size_t n_channels);
+    ~basic_multichannel_butterworth();
+
+    /** Get second order sections of filter (shared by all channels)
+     *
+     * @return vector of biquads (second order sections)
+     */
+    std::vector<basic_biquad<T>> get_sections() { return m_sections; }
+
+    /** Get number of channels
+     *
+     * @return number of channels
+     */
+    std::size_t get_channels() { return m_n_channels; }
+
+    /** Get number of channels processed in parallel (SIMD lanes)
+     *
+     * @return number of lanes
+     */
+    std::size_t get_lanes();
+
+    /** Get the instruction set of the kernels used by this filter
+     *
+     * @return instruction set
+     */
+    simd::instruction_set get_instruction_set();
+
+    /** Process a single frame (one sample of every channel).
+     *
+     * @param in input frame (n_channels samples)
+     * @param out output frame (n_channels samples)
+     */
+    void process(const T *in, T *out) { process_interleaved(in, out, 1); }
+
+    /** Process interleaved samples (frame by frame: ch0, ch1, ..., ch0, ch1, ...).
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param in input samples (n_frames * n_channels)
+     * @param out output buffer (n_frames * n_channels)
+     * @param n_frames number of frames
+     */
+    void process_interleaved(const T *in, T *out, std::size_t n_frames);
+
+    /** Process planar samples (one buffer per channel).
+     *
+     * `in[ch]` and `out[ch]` may point to the same buffer.
+     *
+     * @param in input buffers (n_channels buffers with n_samples samples)
+     * @param out output buffers (n_channels buffers with n_samples samples)
+     * @param n_samples number of samples per channel
+     */
+    void process_planar(const T *const *in, T *const *out, std::size_t n_samples);
+};
+
+// double precision samples, coefficients and state
+using multichannel_butterworth = basic_multichannel_butterworth<double>;
+
+#endif //!__MULTICHANNEL_BUTTERWORTH__H__
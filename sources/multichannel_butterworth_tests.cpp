@@ -0,0 +1,153 @@
+#include <vector>
+#include <cmath>
+
+#include "butterworth.h"
+#include "multichannel_butterworth.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // different test signal for every channel
+    std::vector<std::vector<double>> test_signals(std::size_t n_channels, std::size_t n_samples)
+    {
+        std::vector<std::vector<double>> signals(n_channels);
+        for (std::size_t ch = 0; ch < n_channels; ch++)
+        {
+            for (std::size_t i = 0; i < n_samples; i++)
+            {
+                signals[ch].push_back(std::sin(0.05 * (ch + 1) * i) + 0.5 * std::sin(1.3 * i + ch));
+            }
+        }
+        return signals;
+    }
+}
+
+TEST(multichannel_butterworth_test, interleaved)
+{
+    const double EPSILON = 1.0e-9;
+
+    for (simd::instruction_set isa : simd::supported_instruction_sets())
+    {
+        simd::set_instruction_set(isa);
+
+        // channel counts below, equal to and above a multiple of the lane count
+        std::size_t lanes = simd::get_kernels().f64.lanes;
+        for (std::size_t n_channels : {std::size_t(1), std::size_t(5), lanes, lanes + 3})
+        {
+            std::size_t n_samples = 300;
+            std::vector<std::vector<double>> signals(test_signals(n_channels, n_samples));
+
+            std::vector<double> interleaved;
+            for (std::size_t i = 0; i < n_samples; i++)
+            {
+                for (std::size_t ch = 0; ch < n_channels; ch++)
+                {
+                    interleaved.push_back(signals[ch][i]);
+                }
+            }
+
+            multichannel_butterworth filter{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, n_channels};
+            EXPECT_EQ(n_channels, filter.get_channels());
+            EXPECT_EQ(isa, filter.get_instruction_set());
+
+            // a block, a single frame and the (in-place) rest
+            std::vector<double> result(interleaved.size());
+            filter.process_interleaved(interleaved.data(), result.data(), 100);
+            filter.process(interleaved.data() + 100 * n_channels, result.data() + 100 * n_channels);
+            std::copy(interleaved.begin() + 101 * n_channels, interleaved.end(), result.begin() + 101 * n_channels);
+            filter.process_interleaved(result.data() + 101 * n_channels, result.data() + 101 * n_channels, n_samples - 101);
+
+            for (std::size_t ch = 0; ch < n_channels; ch++)
+            {
+                butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50,
+                                      biquad_structure::transposed_direct_form_2};
+                std::vector<double> expected(reference.process(signals[ch]));
+                for (std::size_t i = 0; i < n_samples; i++)
+                {
+                    EXPECT_NEAR(expected[i], result[i * n_channels + ch], EPSILON);
+                }
+            }
+        }
+    }
+    simd::reset_instruction_set();
+}
+
+TEST(multichannel_butterworth_test, planar)
+{
+    const double EPSILON = 1.0e-9;
+    std::size_t n_channels = 7;
+    std::size_t n_samples = 200;
+    std::vector<std::vector<double>> signals(test_signals(n_channels, n_samples));
+    std::vector<std::vector<double>> results(n_channels, std::vector<double>(n_samples));
+
+    std::vector<const double *> in;
+    std::vector<double *> out;
+    for (std::size_t ch = 0; ch < n_channels; ch++)
+    {
+        in.push_back(signals[ch].data());
+        out.push_back(results[ch].data());
+    }
+
+    for (simd::instruction_set isa : simd::supported_instruction_sets())
+    {
+        simd::set_instruction_set(isa);
+        multichannel_butterworth filter{5, std::vector<double>{12}, filter_design::filter_type::lowpass, 50, n_channels};
+        filter.process_planar(in.data(), out.data(), n_samples);
+
+        for (std::size_t ch = 0; ch < n_channels; ch++)
+        {
+            butterworth reference{5, std::vector<double>{12}, filter_design::filter_type::lowpass, 50,
+                                  biquad_structure::transposed_direct_form_2};
+            std::vector<double> expected(reference.process(signals[ch]));
+            for (std::size_t i = 0; i < n_samples; i++)
+            {
+                EXPECT_NEAR(expected[i], results[ch][i], EPSILON);
+            }
+        }
+    }
+    simd::reset_instruction_set();
+}
+
+TEST(multichannel_butterworth_test, single_precision)
+{
+    const double EPSILON = 1.0e-5;
+    std::size_t n_samples = 300;
+
+    for (simd::instruction_set isa : simd::supported_instruction_sets())
+    {
+        simd::set_instruction_set(isa);
+
+        // float fills twice as many lanes as double
+        std::size_t lanes = simd::get_kernels().f32.lanes;
+        EXPECT_EQ(2 * simd::get_kernels().f64.lanes, lanes);
+        std::size_t n_channels = lanes + 3;
+        std::vector<std::vector<double>> signals(test_signals(n_channels, n_samples));
+
+        std::vector<float> interleaved;
+        for (std::size_t i = 0; i < n_samples; i++)
+        {
+            for (std::size_t ch = 0; ch < n_channels; ch++)
+            {
+                interleaved.push_back(static_cast<float>(signals[ch][i]));
+            }
+        }
+
+        basic_multichannel_butterworth<float> filter{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, n_channels};
+        EXPECT_EQ(lanes, filter.get_lanes());
+        std::vector<float> result(interleaved.size());
+        filter.process_interleaved(interleaved.data(), result.data(), n_samples);
+
+        for (std::size_t ch = 0; ch < n_channels; ch++)
+        {
+            butterworth reference{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50,
+                                  biquad_structure::transposed_direct_form_2};
+            std::vector<double> expected(reference.process(signals[ch]));
+            for (std::size_t i = 0; i < n_samples; i++)
+            {
+                EXPECT_NEAR(expected[i], result[i * n_channels + ch], EPSILON);
+            }
+        }
+    }
+    simd::reset_instruction_set();
+}
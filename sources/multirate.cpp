@@ -0,0 +1,282 @@
+#include "multirate.h"
+#include "filter_design.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    /** Butterworth lowpass of a rate change (cutoff relative to the Nyquist frequency of the lower rate).
+     *
+     * @param factor rate change factor
+     * @param filter_order order of the lowpass
+     * @param cutoff cutoff frequency as fraction of the Nyquist frequency of the lower rate
+     * @return second order sections at the higher rate
+     */
+    std::vector<biquad> design_lowpass(std::size_t factor, int filter_order, double cutoff)
+    {
+        if (factor == 0)
+        {
+            throw std::invalid_argument("Rate change factor must be at least 1");
+        }
+        if (cutoff <= 0 || cutoff >= 1)
+        {
+            throw std::invalid_argument("Cutoff must be 0 < cutoff < 1 (fraction of the Nyquist frequency of the lower rate)");
+        }
+        return filter_design::butter(filter_order, std::vector<double>{cutoff / factor}, filter_design::filter_type::lowpass, 2.0);
+    }
+
+    /** Product of the numerators of all sections (b0 + b1 z^-1 + b2 z^-2), trailing zeros removed.
+     *
+     * @param sections second order sections
+     * @param scale factor applied to all coefficients
+     * @return coefficients of the FIR filter
+     */
+    template <typename T>
+    std::vector<T> numerator(const std::vector<biquad> &sections, double scale)
+    {
+        std::vector<double> b{scale};
+        for (const biquad &section : sections)
+        {
+            std::vector<double> coefficients(section.get_coefficients());
+            std::vector<double> product(b.size() + 2, 0.0);
+            for (std::size_t i = 0; i < b.size(); i++)
+            {
+                for (std::size_t k = 0; k < 3; k++)
+                {
+                    product[i + k] += b[i] * coefficients[k];
+                }
+            }
+            b = product;
+        }
+        while (b.size() > 1 && b.back() == 0)
+        {
+            b.pop_back();
+        }
+        return std::vector<T>(b.begin(), b.end());
+    }
+
+    /** Feedback coefficients of all sections.
+     *
+     * @param sections second order sections
+     * @return a1, a2 per section
+     */
+    template <typename T>
+    std::vector<T> denominator(const std::vector<biquad> &sections)
+    {
+        std::vector<T> a;
+        for (const biquad &section : sections)
+        {
+            std::vector<double> coefficients(section.get_coefficients());
+            a.push_back(static_cast<T>(coefficients[3]));
+            a.push_back(static_cast<T>(coefficients[4]));
+        }
+        return a;
+    }
+
+    // sections whose recursions are interleaved per sample (see FUSED_SECTIONS in biquad_step.h)
+    constexpr std::size_t FUSED_SECTIONS = 4;
+
+    /** Push samples through the all-pole parts of N consecutive sections (in place), one sample through all
+     * of them at a time, so the recursions of the sections overlap in the pipeline.
+     *
+     * @param denominator a1, a2 per section
+     * @param state y[n-1], y[n-2] per section
+     * @param data samples
+     * @param n number of samples
+     */
+    template <std::size_t N, typename T>
+    void process_poles_fused(const T *denominator, T *state, T *data, std::size_t n)
+    {
+        T a1[N], a2[N], y1[N], y2[N];
+        for (std::size_t s = 0; s < N; s++)
+        {
+            a1[s] = denominator[2 * s];
+            a2[s] = denominator[2 * s + 1];
+            y1[s] = state[2 * s];
+            y2[s] = state[2 * s + 1];
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T x = data[i];
+            for (std::size_t s = 0; s < N; s++)
+            {
+                T y = x - a1[s] * y1[s] - a2[s] * y2[s];
+                y2[s] = y1[s];
+                y1[s] = y;
+                x = y;
+            }
+            data[i] = x;
+        }
+        for (std::size_t s = 0; s < N; s++)
+        {
+            state[2 * s] = y1[s];
+            state[2 * s + 1] = y2[s];
+        }
+    }
+
+    /** Push samples through the all-pole parts of the sections (in place).
+     *
+     * @param denominator a1, a2 per section
+     * @param state y[n-1], y[n-2] per section
+     * @param n_sections number of sections
+     * @param data samples
+     * @param n number of samples
+     */
+    template <typename T>
+    void process_poles(const T *denominator, T *state, std::size_t n_sections, T *data, std::size_t n)
+    {
+        static_assert(FUSED_SECTIONS == 4, "Adapt the group size dispatch below");
+
+        for (std::size_t s = 0; s < n_sections; s += FUSED_SECTIONS)
+        {
+            switch (std::min(FUSED_SECTIONS, n_sections - s))
+            {
+            case 1:
+                process_poles_fused<1>(denominator + 2 * s, state + 2 * s, data, n);
+                break;
+            case 2:
+                process_poles_fused<2>(denominator + 2 * s, state + 2 * s, data, n);
+                break;
+            case 3:
+                process_poles_fused<3>(denominator + 2 * s, state + 2 * s, data, n);
+                break;
+            default:
+                process_poles_fused<FUSED_SECTIONS>(denominator + 2 * s, state + 2 * s, data, n);
+                break;
+            }
+        }
+    }
+} // namespace
+
+template <typename T>
+basic_decimator<T>::basic_decimator(std::size_t factor, int filter_order, double cutoff)
+    : m_factor(factor),
+      m_sections(design_lowpass(factor, filter_order, cutoff)),
+      m_numerator(numerator<T>(m_sections, 1.0)),
+      m_denominator(denominator<T>(m_sections)),
+      m_state(2 * m_sections.size(), T(0)),
+      m_buffer(m_numerator.size() - 1 + TILE_SIZE, T(0))
+{
+}
+
+template <typename T>
+std::size_t basic_decimator<T>::get_output_size(std::size_t n) const
+{
+    std::size_t first = (m_factor - m_phase) % m_factor;
+    return (first < n) ? (n - first - 1) / m_factor + 1 : 0;
+}
+
+template <typename T>
+std::size_t basic_decimator<T>::process(const T *in, T *out, std::size_t n)
+{
+    const std::size_t history = m_numerator.size() - 1;
+    std::size_t n_out = 0;
+
+    for (std::size_t tile = 0; tile < n; tile += TILE_SIZE)
+    {
+        std::size_t tile_size = std::min(TILE_SIZE, n - tile);
+
+        // the recursion runs for every sample
+        T *w = m_buffer.data() + history;
+        std::copy(in + tile, in + tile + tile_size, w);
+        process_poles(m_denominator.data(), m_state.data(), m_sections.size(), w, tile_size);
+
+        // the zeros only for the kept samples
+        for (std::size_t i = (m_factor - m_phase) % m_factor; i < tile_size; i += m_factor)
+        {
+            const T *x = w + i;
+            T y = 0;
+            for (std::size_t k = 0; k < m_numerator.size(); k++)
+            {
+                y += m_numerator[k] * *(x - k);
+            }
+            out[n_out++] = y;
+        }
+        m_phase = (m_phase + tile_size) % m_factor;
+
+        // keep the last outputs of the recursion for the next tile
+        std::copy(m_buffer.begin() + tile_size, m_buffer.begin() + tile_size + history, m_buffer.begin());
+    }
+
+    return n_out;
+}
+
+template <typename T>
+std::vector<T> basic_decimator<T>::process(const std::vector<T> &samples)
+{
+    std::vector<T> result(get_output_size(samples.size()));
+    process(samples.data(), result.data(), samples.size());
+    return result;
+}
+
+template <typename T>
+void basic_decimator<T>::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), T(0));
+    std::fill(m_buffer.begin(), m_buffer.end(), T(0));
+    m_phase = 0;
+}
+
+template <typename T>
+basic_interpolator<T>::basic_interpolator(std::size_t factor, int filter_order, double cutoff)
+    : m_factor(factor),
+      m_sections(design_lowpass(factor, filter_order, cutoff)),
+      m_numerator(numerator<T>(m_sections, static_cast<double>(factor))),
+      m_denominator(denominator<T>(m_sections)),
+      m_state(2 * m_sections.size(), T(0)),
+      m_history((m_numerator.size() + factor - 1) / factor, T(0))
+{
+}
+
+template <typename T>
+void basic_interpolator<T>::process(const T *in, T *out, std::size_t n)
+{
+    // input samples per tile, the outputs of a tile stay in cache for the recursion
+    const std::size_t tile_inputs = std::max<std::size_t>(1, TILE_SIZE / m_factor);
+    const std::size_t n_taps = m_numerator.size();
+
+    for (std::size_t tile = 0; tile < n; tile += tile_inputs)
+    {
+        std::size_t tile_size = std::min(tile_inputs, n - tile);
+        T *y = out + tile * m_factor;
+
+        // polyphase FIR: output m * factor + p only sees the taps p, p + factor, p + 2 * factor, ...
+        for (std::size_t m = 0; m < tile_size; m++)
+        {
+            std::copy_backward(m_history.begin(), m_history.end() - 1, m_history.end());
+            m_history[0] = in[tile + m];
+            for (std::size_t p = 0; p < m_factor; p++)
+            {
+                T u = 0;
+                for (std::size_t k = p, q = 0; k < n_taps; k += m_factor, q++)
+                {
+                    u += m_numerator[k] * m_history[q];
+                }
+                y[m * m_factor + p] = u;
+            }
+        }
+
+        process_poles(m_denominator.data(), m_state.data(), m_sections.size(), y, tile_size * m_factor);
+    }
+}
+
+template <typename T>
+std::vector<T> basic_interpolator<T>::process(const std::vector<T> &samples)
+{
+    std::vector<T> result(samples.size() * m_factor);
+    process(samples.data(), result.data(), samples.size());
+    return result;
+}
+
+template <typename T>
+void basic_interpolator<T>::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), T(0));
+    std::fill(m_history.begin(), m_history.end(), T(0));
+}
+
+template class basic_decimator<double>;
+template class basic_decimator<float>;
+template class basic_interpolator<double>;
+template class basic_interpolator<float>;
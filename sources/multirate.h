@@ -0,0 +1,145 @@
+#ifndef __MULTIRATE__H__
+#define __MULTIRATE__H__
+
+#include <vector>
+#include <cstddef>
+#include "biquad.h"
+
+/** Butterworth lowpass and integer downsampling in one stage.
+ *
+ * @tparam T sample, coefficient and state type (explicitly instantiated for float and double)
+ *
+ * The output equals filtering with butterworth (lowpass) and keeping every factor-th sample, starting with
+ * the first one. The recursion of the cascade (the poles) has to run for every input sample, the numerator
+ * (the zeros) is only evaluated for the samples that are kept: the sections are split into their all-pole
+ * parts, followed by the product of all numerators as one FIR filter. Only kept samples are written.
+ */
+template <typename T>
+class basic_decimator
+{
+private:
+    static constexpr std::size_t TILE_SIZE = 256;
+
+    std::size_t m_factor;
+    std::vector<biquad> m_sections;
+    std::vector<T> m_numerator;   // product of the numerators of all sections (b[0], ..., b[N])
+    std::vector<T> m_denominator; // a1, a2 per section
+    std::vector<T> m_state;       // y[n-1], y[n-2] of the all-pole part of every section
+    std::vector<T> m_buffer;      // last N outputs of the all-pole cascade, followed by the current tile
+    std::size_t m_phase = 0;      // position of the next input sample in the current period of factor samples
+
+public:
+    /** Decimator with a Butterworth lowpass as anti-aliasing filter.
+     *
+     * @param factor downsampling factor (keep every factor-th sample), throws std::invalid_argument if 0
+     * @param filter_order order of the lowpass
+     * @param cutoff cutoff frequency of the lowpass as fraction of the output Nyquist frequency (0 < cutoff < 1)
+     */
+    explicit basic_decimator(std::size_t factor, int filter_order = 8, double cutoff = 0.8);
+
+    /** Get downsampling factor
+     *
+     * @return factor
+     */
+    std::size_t get_factor() const { return m_factor; }
+
+    /** Get second order sections of the lowpass (in double precision)
+     *
+     * @return vector of biquads (second order sections)
+     */
+    std::vector<biquad> get_sections() const { return m_sections; }
+
+    /** Get number of output samples of the next n input samples
+     *
+     * @param n number of input samples
+     * @return number of output samples
+     */
+    std::size_t get_output_size(std::size_t n) const;
+
+    /** Process a block of samples (blocks do not need to be multiples of the factor).
+     *
+     * @param in input samples
+     * @param out output buffer (at least get_output_size(n) samples)
+     * @param n number of input samples
+     * @return number of output samples written
+     */
+    std::size_t process(const T *in, T *out, std::size_t n);
+
+    /** Process samples
+     *
+     * @param samples input samples
+     * @return kept samples
+     */
+    std::vector<T> process(const std::vector<T> &samples);
+
+    /** Reset the state to zero and start a new period with the next sample. */
+    void reset();
+};
+
+/** Zero-stuffing upsampling and Butterworth lowpass in one stage.
+ *
+ * @tparam T sample, coefficient and state type (explicitly instantiated for float and double)
+ *
+ * The output equals inserting factor - 1 zeros after every sample, filtering with butterworth (lowpass) and
+ * scaling by factor (to keep the amplitude). The zeros are never stored or multiplied: the numerators of all
+ * sections are combined into one FIR filter evaluated in polyphase form on the input samples (about
+ * N / factor multiplications per output sample), followed by the all-pole parts of the sections.
+ */
+template <typename T>
+class basic_interpolator
+{
+private:
+    static constexpr std::size_t TILE_SIZE = 256;
+
+    std::size_t m_factor;
+    std::vector<biquad> m_sections;
+    std::vector<T> m_numerator;   // product of the numerators of all sections times factor (b[0], ..., b[N])
+    std::vector<T> m_denominator; // a1, a2 per section
+    std::vector<T> m_state;       // y[n-1], y[n-2] of the all-pole part of every section
+    std::vector<T> m_history;     // last input samples (newest first), one per tap of a polyphase branch
+
+public:
+    /** Interpolator with a Butterworth lowpass as anti-imaging filter.
+     *
+     * @param factor upsampling factor (factor output samples per input sample), throws std::invalid_argument if 0
+     * @param filter_order order of the lowpass
+     * @param cutoff cutoff frequency of the lowpass as fraction of the input Nyquist frequency (0 < cutoff < 1)
+     */
+    explicit basic_interpolator(std::size_t factor, int filter_order = 8, double cutoff = 0.8);
+
+    /** Get upsampling factor
+     *
+     * @return factor
+     */
+    std::size_t get_factor() const { return m_factor; }
+
+    /** Get second order sections of the lowpass (in double precision)
+     *
+     * @return vector of biquads (second order sections)
+     */
+    std::vector<biquad> get_sections() const { return m_sections; }
+
+    /** Process a block of samples.
+     *
+     * @param in input samples
+     * @param out output buffer (at least n * factor samples)
+     * @param n number of input samples
+     */
+    void process(const T *in, T *out, std::size_t n);
+
+    /** Process samples
+     *
+     * @param samples input samples
+     * @return upsampled samples (samples.size() * factor)
+     */
+    std::vector<T> process(const std::vector<T> &samples);
+
+    /** Reset the state to zero. */
+    void reset();
+};
+
+// double precision samples, coefficients and state
+using decimator = basic_decimator<double>;
+using interpolator = basic_interpolator<double>;
+
+#endif //!__MULTIRATE__H__
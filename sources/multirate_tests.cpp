@@ -0,0 +1,125 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "butterworth.h"
+#include "multirate.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::vector<double> test_signal(std::size_t n_samples)
+    {
+        std::vector<double> signal;
+        for (std::size_t i = 0; i < n_samples; i++)
+        {
+            signal.push_back(std::sin(0.01 * i) + 0.5 * std::sin(0.3 * i) + 0.25 * std::sin(2.9 * i));
+        }
+        return signal;
+    }
+}
+
+TEST(multirate_test, decimator)
+{
+    const double EPSILON = 1.0e-9;
+
+    std::vector<double> signal(test_signal(1000));
+    for (std::size_t factor : {1, 2, 3, 8})
+    {
+        for (int order : {1, 4, 7})
+        {
+            SCOPED_TRACE(testing::Message() << "factor " << factor << ", order " << order);
+
+            // filter every sample, keep every factor-th one
+            butterworth lowpass{order, std::vector<double>{0.8 / factor}, filter_design::filter_type::lowpass, 2.0};
+            std::vector<double> filtered(lowpass.process(signal));
+            std::vector<double> expected;
+            for (std::size_t i = 0; i < filtered.size(); i += factor)
+            {
+                expected.push_back(filtered[i]);
+            }
+
+            // blocks that are not multiples of the factor (and longer than a tile)
+            decimator stage{factor, order};
+            EXPECT_EQ(factor, stage.get_factor());
+            EXPECT_EQ(lowpass.get_sections().size(), stage.get_sections().size());
+            std::vector<double> result(expected.size());
+            std::size_t n_out = 0;
+            for (std::size_t start = 0, block = 1; start < signal.size(); start += block, block = block * 3 + 1)
+            {
+                std::size_t n = std::min(block, signal.size() - start);
+                std::size_t expected_size = stage.get_output_size(n);
+                EXPECT_EQ(expected_size, stage.process(signal.data() + start, result.data() + n_out, n));
+                n_out += expected_size;
+            }
+            ASSERT_EQ(expected.size(), n_out);
+            for (std::size_t i = 0; i < expected.size(); i++)
+            {
+                EXPECT_NEAR(expected[i], result[i], EPSILON);
+            }
+
+            stage.reset();
+            EXPECT_EQ(result, stage.process(signal)) << "reset restarts the period";
+        }
+    }
+
+    EXPECT_THROW(decimator(0), std::invalid_argument);
+    EXPECT_THROW(decimator(4, 8, 1.0), std::invalid_argument);
+}
+
+TEST(multirate_test, decimator_float)
+{
+    std::vector<double> signal(test_signal(1000));
+    butterworth lowpass{8, std::vector<double>{0.1}, filter_design::filter_type::lowpass, 2.0};
+    std::vector<double> filtered(lowpass.process(signal));
+
+    basic_decimator<float> stage{8};
+    std::vector<float> result(stage.process(std::vector<float>(signal.begin(), signal.end())));
+    ASSERT_EQ(125u, result.size());
+    for (std::size_t i = 0; i < result.size(); i++)
+    {
+        EXPECT_NEAR(filtered[8 * i], result[i], 1.0e-4);
+    }
+}
+
+TEST(multirate_test, interpolator)
+{
+    const double EPSILON = 1.0e-9;
+
+    std::vector<double> signal(test_signal(300));
+    for (std::size_t factor : {1, 2, 3, 8, 300})
+    {
+        for (int order : {1, 4, 7})
+        {
+            SCOPED_TRACE(testing::Message() << "factor " << factor << ", order " << order);
+
+            // zero stuffing, filtering and gain
+            std::vector<double> stuffed(signal.size() * factor, 0.0);
+            for (std::size_t i = 0; i < signal.size(); i++)
+            {
+                stuffed[i * factor] = factor * signal[i];
+            }
+            butterworth lowpass{order, std::vector<double>{0.8 / factor}, filter_design::filter_type::lowpass, 2.0};
+            std::vector<double> expected(lowpass.process(stuffed));
+
+            interpolator stage{factor, order};
+            EXPECT_EQ(factor, stage.get_factor());
+            std::vector<double> result(expected.size());
+            stage.process(signal.data(), result.data(), 100);
+            stage.process(signal.data() + 100, result.data() + 100 * factor, signal.size() - 100);
+            for (std::size_t i = 0; i < expected.size(); i++)
+            {
+                EXPECT_NEAR(expected[i], result[i], EPSILON);
+            }
+
+            stage.reset();
+            std::vector<double> restarted(stage.process(signal));
+            ASSERT_EQ(expected.size(), restarted.size());
+            EXPECT_NEAR(expected.back(), restarted.back(), EPSILON);
+        }
+    }
+
+    EXPECT_THROW(interpolator(0), std::invalid_argument);
+    EXPECT_THROW(interpolator(4, 8, 0.0), std::invalid_argument);
+}
@@ -0,0 +1,598 @@
+#include "sample_io.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "sample_io stores samples in host byte order and supports little-endian hosts only"
+#endif
+
+namespace
+{
+    const std::uint16_t WAV_PCM = 1;
+    const std::uint16_t WAV_IEEE_FLOAT = 3;
+    const std::uint16_t WAV_EXTENSIBLE = 0xFFFE;
+    const char NPY_MAGIC[] = "\x93NUMPY";
+
+    std::uint16_t get_u16(const unsigned char *bytes)
+    {
+        return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    std::uint32_t get_u32(const unsigned char *bytes)
+    {
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    void put_u16(std::string &bytes, std::uint16_t value)
+    {
+        bytes.push_back(static_cast<char>(value & 0xFF));
+        bytes.push_back(static_cast<char>(value >> 8));
+    }
+
+    void put_u32(std::string &bytes, std::uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            bytes.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    template <typename S>
+    void decode(const void *in, double *out, std::size_t n)
+    {
+        const S *samples = static_cast<const S *>(in);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            out[i] = static_cast<double>(samples[i]);
+        }
+    }
+
+    template <typename S>
+    void encode(const double *in, void *out, std::size_t n)
+    {
+        S *samples = static_cast<S *>(out);
+        if constexpr (std::numeric_limits<S>::is_integer)
+        {
+            const double low = static_cast<double>(std::numeric_limits<S>::min());
+            const double high = static_cast<double>(std::numeric_limits<S>::max());
+            for (std::size_t i = 0; i < n; i++)
+            {
+                samples[i] = static_cast<S>(std::min(high, std::max(low, std::nearbyint(in[i]))));
+            }
+            return;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            samples[i] = static_cast<S>(in[i]);
+        }
+    }
+
+    // NumPy type string of a sample format
+    const char *npy_descr(sample_format format)
+    {
+        switch (format)
+        {
+        case sample_format::int16:
+            return "<i2";
+        case sample_format::int32:
+            return "<i4";
+        case sample_format::float32:
+            return "<f4";
+        case sample_format::float64:
+            return "<f8";
+        }
+        throw std::invalid_argument("Unknown sample format");
+    }
+
+    /** Get the value of a key in the dictionary of a .npy header (up to the next comma outside of brackets).
+     *
+     * @return value, empty if the key is missing
+     */
+    std::string npy_value(const std::string &header, const std::string &key)
+    {
+        std::size_t start = header.find("'" + key + "'");
+        if (start == std::string::npos)
+        {
+            return "";
+        }
+        start = header.find(':', start);
+        if (start == std::string::npos)
+        {
+            return "";
+        }
+        start = header.find_first_not_of(' ', start + 1);
+        std::size_t end = header.find(header[start] == '(' ? ')' : ',', start);
+        if (end == std::string::npos)
+        {
+            return "";
+        }
+        return header.substr(start, end - start + (header[start] == '(' ? 1 : 0));
+    }
+
+    // type of a file that describes its samples in a header
+    file_type header_file_type(const std::string &path)
+    {
+        file_type type = get_file_type(path);
+        if (type == file_type::raw)
+        {
+            throw std::invalid_argument("Format of '" + path + "' unknown, raw files need format and channels");
+        }
+        return type;
+    }
+} // namespace
+
+std::runtime_error system_error(const std::string &what, const std::string &path)
+{
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+std::size_t get_sample_size(sample_format format)
+{
+    switch (format)
+    {
+    case sample_format::int16:
+        return sizeof(std::int16_t);
+    case sample_format::int32:
+        return sizeof(std::int32_t);
+    case sample_format::float32:
+        return sizeof(float);
+    case sample_format::float64:
+        return sizeof(double);
+    }
+    throw std::invalid_argument("Unknown sample format");
+}
+
+sample_format parse_sample_format(const std::string &name)
+{
+    if (name == "s16" || name == "int16")
+    {
+        return sample_format::int16;
+    }
+    if (name == "s32" || name == "int32")
+    {
+        return sample_format::int32;
+    }
+    if (name == "f32" || name == "float32")
+    {
+        return sample_format::float32;
+    }
+    if (name == "f64" || name == "float64")
+    {
+        return sample_format::float64;
+    }
+    throw std::invalid_argument("Unknown sample format '" + name + "' (s16, s32, f32 or f64)");
+}
+
+file_type get_file_type(const std::string &path)
+{
+    std::size_t dot = path.rfind('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".wav")
+    {
+        return file_type::wav;
+    }
+    if (extension == ".npy")
+    {
+        return file_type::npy;
+    }
+    return file_type::raw;
+}
+
+void decode_samples(sample_format format, const void *in, double *out, std::size_t n)
+{
+    switch (format)
+    {
+    case sample_format::int16:
+        decode<std::int16_t>(in, out, n);
+        break;
+    case sample_format::int32:
+        decode<std::int32_t>(in, out, n);
+        break;
+    case sample_format::float32:
+        decode<float>(in, out, n);
+        break;
+    case sample_format::float64:
+        decode<double>(in, out, n);
+        break;
+    }
+}
+
+void encode_samples(sample_format format, const double *in, void *out, std::size_t n)
+{
+    switch (format)
+    {
+    case sample_format::int16:
+        encode<std::int16_t>(in, out, n);
+        break;
+    case sample_format::int32:
+        encode<std::int32_t>(in, out, n);
+        break;
+    case sample_format::float32:
+        encode<float>(in, out, n);
+        break;
+    case sample_format::float64:
+        encode<double>(in, out, n);
+        break;
+    }
+}
+
+sample_reader::sample_reader(const std::string &path)
+    : sample_reader(path, header_file_type(path), sample_format::float64, 1)
+{
+}
+
+sample_reader::sample_reader(const std::string &path, file_type type, sample_format format, std::size_t n_channels)
+    : m_path(path), m_format(format), m_n_channels(n_channels)
+{
+    m_file = std::fopen(path.c_str(), "rb");
+    if (m_file == nullptr)
+    {
+        throw system_error("Cannot open", path);
+    }
+    try
+    {
+        if (type == file_type::wav)
+        {
+            read_wav_header();
+        }
+        else if (type == file_type::npy)
+        {
+            read_npy_header();
+        }
+        else
+        {
+            if (n_channels == 0)
+            {
+                throw std::invalid_argument("Number of channels must be at least 1");
+            }
+            std::fseek(m_file, 0, SEEK_END);
+            std::size_t size = static_cast<std::size_t>(std::ftell(m_file));
+            std::fseek(m_file, 0, SEEK_SET);
+            std::size_t frame_size = m_n_channels * get_sample_size(m_format);
+            if (size % frame_size != 0)
+            {
+                throw std::invalid_argument("Size of '" + path + "' is not a multiple of the frame size (" + std::to_string(frame_size) + " bytes)");
+            }
+            m_n_frames = size / frame_size;
+        }
+    }
+    catch (...)
+    {
+        std::fclose(m_file);
+        throw;
+    }
+}
+
+sample_reader::~sample_reader()
+{
+    std::fclose(m_file);
+}
+
+void sample_reader::read_wav_header()
+{
+    unsigned char riff[12];
+    if (std::fread(riff, 1, sizeof(riff), m_file) != sizeof(riff) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        throw std::invalid_argument("'" + m_path + "' is not a WAV file");
+    }
+
+    bool has_format = false;
+    std::size_t block_align = 0;
+    unsigned char chunk[8];
+    while (std::fread(chunk, 1, sizeof(chunk), m_file) == sizeof(chunk))
+    {
+        std::uint32_t size = get_u32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            unsigned char fmt[40] = {};
+            std::size_t n = std::min<std::size_t>(size, sizeof(fmt));
+            if (size < 16 || std::fread(fmt, 1, n, m_file) != n)
+            {
+                throw std::invalid_argument("Invalid format chunk in '" + m_path + "'");
+            }
+            std::uint16_t tag = get_u16(fmt);
+            if (tag == WAV_EXTENSIBLE && size >= 40)
+            {
+                tag = get_u16(fmt + 24); // first two bytes of the sub format GUID
+            }
+            m_n_channels = get_u16(fmt + 2);
+            m_sampling_frequency = get_u32(fmt + 4);
+            block_align = get_u16(fmt + 12);
+            std::uint16_t bits = get_u16(fmt + 14);
+            if (tag == WAV_PCM && bits == 16)
+            {
+                m_format = sample_format::int16;
+            }
+            else if (tag == WAV_PCM && bits == 32)
+            {
+                m_format = sample_format::int32;
+            }
+            else if (tag == WAV_IEEE_FLOAT && bits == 32)
+            {
+                m_format = sample_format::float32;
+            }
+            else if (tag == WAV_IEEE_FLOAT && bits == 64)
+            {
+                m_format = sample_format::float64;
+            }
+            else
+            {
+                throw std::invalid_argument("Unsupported WAV format in '" + m_path + "' (format " + std::to_string(tag) + ", " + std::to_string(bits) + " bits)");
+            }
+            if (m_n_channels == 0 || block_align != m_n_channels * get_sample_size(m_format))
+            {
+                throw std::invalid_argument("Invalid format chunk in '" + m_path + "'");
+            }
+            has_format = true;
+            std::fseek(m_file, static_cast<long>(size - n + (size & 1)), SEEK_CUR);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!has_format)
+            {
+                throw std::invalid_argument("Data chunk before format chunk in '" + m_path + "'");
+            }
+            // streamed writers leave the size open, the data then extends to the end of the file
+            long start = std::ftell(m_file);
+            std::fseek(m_file, 0, SEEK_END);
+            std::size_t available = static_cast<std::size_t>(std::ftell(m_file) - start);
+            std::fseek(m_file, start, SEEK_SET);
+            std::size_t data_size = (size == 0 || size == 0xFFFFFFFF) ? available : std::min<std::size_t>(size, available);
+            m_n_frames = data_size / block_align;
+            return;
+        }
+        else
+        {
+            std::fseek(m_file, static_cast<long>(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    throw std::invalid_argument("No data chunk in '" + m_path + "'");
+}
+
+void sample_reader::read_npy_header()
+{
+    // magic, version and header length (2 bytes in version 1, 4 bytes in versions 2 and 3)
+    unsigned char preamble[12];
+    if (std::fread(preamble, 1, 8, m_file) != 8 || std::memcmp(preamble, NPY_MAGIC, 6) != 0)
+    {
+        throw std::invalid_argument("'" + m_path + "' is not a .npy file");
+    }
+    if (preamble[6] < 1 || preamble[6] > 3)
+    {
+        throw std::invalid_argument("Unsupported .npy version " + std::to_string(preamble[6]) + " in '" + m_path + "'");
+    }
+    std::size_t length_size = preamble[6] == 1 ? 2 : 4;
+    if (std::fread(preamble + 8, 1, length_size, m_file) != length_size)
+    {
+        throw std::invalid_argument("Truncated header in '" + m_path + "'");
+    }
+    std::size_t length = length_size == 2 ? get_u16(preamble + 8) : get_u32(preamble + 8);
+    std::string header(length, ' ');
+    if (std::fread(&header[0], 1, length, m_file) != length)
+    {
+        throw std::invalid_argument("Truncated header in '" + m_path + "'");
+    }
+
+    std::string descr(npy_value(header, "descr"));
+    descr.erase(std::remove(descr.begin(), descr.end(), '\''), descr.end());
+    const sample_format formats[] = {sample_format::int16, sample_format::int32, sample_format::float32, sample_format::float64};
+    const sample_format *format = std::find_if(std::begin(formats), std::end(formats), [&](sample_format f)
+                                               { return descr == npy_descr(f); });
+    if (format == std::end(formats))
+    {
+        throw std::invalid_argument("Unsupported .npy type '" + descr + "' in '" + m_path + "' (<i2, <i4, <f4 or <f8)");
+    }
+    m_format = *format;
+
+    // shape (frames,) or (frames, channels)
+    std::string shape(npy_value(header, "shape"));
+    std::vector<std::size_t> dimensions;
+    for (std::size_t i = 0; i < shape.size();)
+    {
+        if (std::isdigit(static_cast<unsigned char>(shape[i])))
+        {
+            std::size_t end = shape.find_first_not_of("0123456789", i);
+            dimensions.push_back(std::stoull(shape.substr(i, end - i)));
+            i = end;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    if (dimensions.empty() || dimensions.size() > 2)
+    {
+        throw std::invalid_argument("Unsupported .npy shape " + shape + " in '" + m_path + "' (1 or 2 dimensions)");
+    }
+    m_n_frames = dimensions[0];
+    m_n_channels = dimensions.size() == 2 ? dimensions[1] : 1;
+    if (m_n_channels == 0)
+    {
+        throw std::invalid_argument("Unsupported .npy shape " + shape + " in '" + m_path + "' (no channels)");
+    }
+    if (m_n_channels > 1 && npy_value(header, "fortran_order") == "True")
+    {
+        throw std::invalid_argument("Unsupported Fortran order in '" + m_path + "'");
+    }
+}
+
+std::size_t sample_reader::read(double *out, std::size_t max_frames)
+{
+    std::size_t n_frames = std::min(max_frames, m_n_frames - m_position);
+    std::size_t n_samples = n_frames * m_n_channels;
+    m_buffer.resize(n_samples * get_sample_size(m_format));
+    if (std::fread(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size())
+    {
+        throw std::runtime_error("Unexpected end of '" + m_path + "'");
+    }
+    decode_samples(m_format, m_buffer.data(), out, n_samples);
+    m_position += n_frames;
+    return n_frames;
+}
+
+std::vector<double> sample_reader::read()
+{
+    std::vector<double> samples((m_n_frames - m_position) * m_n_channels);
+    read(samples.data(), m_n_frames - m_position);
+    return samples;
+}
+
+sample_writer::sample_writer(const std::string &path, file_type type, sample_format format, std::size_t n_channels, double sampling_frequency)
+    : m_path(path), m_type(type), m_format(format), m_n_channels(n_channels), m_sampling_frequency(sampling_frequency)
+{
+    if (n_channels == 0)
+    {
+        throw std::invalid_argument("Number of channels must be at least 1");
+    }
+    if (type == file_type::wav && (n_channels > 0xFFFF || !(sampling_frequency >= 1 && sampling_frequency < 4294967295.5)))
+    {
+        throw std::invalid_argument("WAV files need 1 to 65535 channels and a sampling frequency of at least 1 Hz");
+    }
+    if (path == "-")
+    {
+        // the headers are completed by seeking back, so only raw samples can go to a pipe
+        if (type != file_type::raw)
+        {
+            throw std::invalid_argument("Only raw samples can be written to the standard output");
+        }
+        m_file = stdout;
+        return;
+    }
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr)
+    {
+        throw system_error("Cannot create", path);
+    }
+    write_header();
+}
+
+sample_writer::~sample_writer()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void sample_writer::write_bytes(const void *data, std::size_t n)
+{
+    if (std::fwrite(data, 1, n, m_file) != n)
+    {
+        throw system_error("Cannot write", m_path);
+    }
+}
+
+void sample_writer::write_header()
+{
+    const std::size_t sample_size = get_sample_size(m_format);
+    std::string header;
+    if (m_type == file_type::wav)
+    {
+        bool is_float = m_format == sample_format::float32 || m_format == sample_format::float64;
+        std::uint32_t data_size = static_cast<std::uint32_t>(m_n_frames * m_n_channels * sample_size);
+        std::uint32_t format_size = is_float ? 18 : 16;
+        std::uint32_t fact_size = is_float ? 12 : 0; // sample frames, required for non PCM data
+
+        header += "RIFF";
+        put_u32(header, 4 + (8 + format_size) + fact_size + (8 + data_size));
+        header += "WAVEfmt ";
+        put_u32(header, format_size);
+        put_u16(header, is_float ? WAV_IEEE_FLOAT : WAV_PCM);
+        put_u16(header, static_cast<std::uint16_t>(m_n_channels));
+        put_u32(header, static_cast<std::uint32_t>(std::lround(m_sampling_frequency)));
+        put_u32(header, static_cast<std::uint32_t>(std::lround(m_sampling_frequency) * m_n_channels * sample_size));
+        put_u16(header, static_cast<std::uint16_t>(m_n_channels * sample_size));
+        put_u16(header, static_cast<std::uint16_t>(8 * sample_size));
+        if (is_float)
+        {
+            put_u16(header, 0);
+            header += "fact";
+            put_u32(header, 4);
+            put_u32(header, static_cast<std::uint32_t>(m_n_frames));
+        }
+        header += "data";
+        put_u32(header, data_size);
+    }
+    else if (m_type == file_type::npy)
+    {
+        std::string shape = m_n_channels == 1 ? std::to_string(m_n_frames) + "," : std::to_string(m_n_frames) + ", " + std::to_string(m_n_channels);
+        std::string dictionary = std::string("{'descr': '") + npy_descr(m_format) + "', 'fortran_order': False, 'shape': (" + shape + "), }";
+        const std::size_t preamble = 10;
+        dictionary.resize(NPY_HEADER_SIZE - preamble - 1, ' ');
+        dictionary += '\n';
+
+        header.append(NPY_MAGIC, 6);
+        header.push_back(1); // version 1.0
+        header.push_back(0);
+        put_u16(header, static_cast<std::uint16_t>(dictionary.size()));
+        header += dictionary;
+    }
+    write_bytes(header.data(), header.size());
+}
+
+void sample_writer::write(const double *in, std::size_t n_frames)
+{
+    const std::size_t n_samples = n_frames * m_n_channels;
+    const std::size_t sample_size = get_sample_size(m_format);
+    if (m_type == file_type::wav && (m_n_frames + n_frames) * m_n_channels * sample_size > 0xFFFFFFFFu - 64)
+    {
+        throw std::runtime_error("WAV file '" + m_path + "' would exceed 4 GiB");
+    }
+    m_buffer.resize(n_samples * sample_size);
+    encode_samples(m_format, in, m_buffer.data(), n_samples);
+    write_bytes(m_buffer.data(), m_buffer.size());
+    m_n_frames += n_frames;
+}
+
+void sample_writer::close()
+{
+    if (m_file == nullptr)
+    {
+        return;
+    }
+    std::FILE *file = m_file;
+    try
+    {
+        if (m_type != file_type::raw)
+        {
+            // the header has the same size with the final number of frames
+            if (std::fseek(m_file, 0, SEEK_SET) != 0)
+            {
+                throw system_error("Cannot seek in", m_path);
+            }
+            write_header();
+        }
+    }
+    catch (...)
+    {
+        m_file = nullptr;
+        std::fclose(file);
+        throw;
+    }
+    m_file = nullptr;
+    if (file == stdout)
+    {
+        if (std::fflush(file) != 0)
+        {
+            throw system_error("Cannot write", m_path);
+        }
+        return;
+    }
+    if (std::fclose(file) != 0)
+    {
+        throw system_error("Cannot close", m_path);
+    }
+}
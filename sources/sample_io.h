@@ -0,0 +1,235 @@
+#ifndef __SAMPLE_IO__H__
+#define __SAMPLE_IO__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Encoding of stored samples (little-endian, channels interleaved frame by frame).
+ *
+ * Integer samples keep their integer scale (no normalization to [-1, 1]), on output they are rounded and
+ * saturated.
+ */
+enum class sample_format
+{
+    int16,   // signed 16 bit integer
+    int32,   // signed 32 bit integer
+    float32, // IEEE 754 single precision
+    float64  // IEEE 754 double precision
+};
+
+/** Container of a sample file. */
+enum class file_type
+{
+    raw, // samples only, format and channels given by the caller
+    wav, // RIFF WAVE, PCM (16 or 32 bit) or IEEE float (32 or 64 bit)
+    npy  // NumPy array, shape (frames,) or (frames, channels) in C order
+};
+
+/** Get the size of one sample
+ *
+ * @param format sample format
+ * @return size in bytes
+ */
+std::size_t get_sample_size(sample_format format);
+
+/** Parse the name of a sample format ("s16"/"int16", "s32"/"int32", "f32"/"float32", "f64"/"float64").
+ *
+ * @param name name of the format, throws std::invalid_argument if unknown
+ * @return sample format
+ */
+sample_format parse_sample_format(const std::string &name);
+
+/** Get the container of a file from its extension (".wav", ".npy", anything else is raw)
+ *
+ * @param path path of the file
+ * @return file type
+ */
+file_type get_file_type(const std::string &path);
+
+/** Convert stored samples to double precision.
+ *
+ * @param format format of the stored samples
+ * @param in stored samples
+ * @param out converted samples
+ * @param n number of samples
+ */
+void decode_samples(sample_format format, const void *in, double *out, std::size_t n);
+
+/** Convert double precision samples to the stored format (integers are rounded and saturated).
+ *
+ * @param format format of the stored samples
+ * @param in samples
+ * @param out stored samples
+ * @param n number of samples
+ */
+void encode_samples(sample_format format, const double *in, void *out, std::size_t n);
+
+/** Build the error of a failed system call on a file (message with the path and strerror(errno)).
+ *
+ * Call it before any other call that may change errno, e.g. close.
+ *
+ * @param what failed operation, e.g. "Cannot open"
+ * @param path path of the file
+ * @return error to throw
+ */
+std::runtime_error system_error(const std::string &what, const std::string &path);
+
+/** Reads interleaved frames from a raw, WAV or .npy file in chunks.
+ *
+ * Only the header is parsed on construction, read converts one chunk at a time, so files larger than the
+ * memory can be streamed through a filter.
+ */
+class sample_reader
+{
+private:
+    std::FILE *m_file = nullptr;
+    std::string m_path;
+    sample_format m_format = sample_format::float64;
+    std::size_t m_n_channels = 1;
+    std::size_t m_n_frames = 0;
+    std::size_t m_position = 0;
+    double m_sampling_frequency = 0;
+    std::vector<unsigned char> m_buffer;
+
+    void read_wav_header();
+    void read_npy_header();
+
+public:
+    /** Open a WAV or .npy file, format and channels are taken from its header.
+     *
+     * @param path path of the file, throws std::runtime_error if it cannot be opened and std::invalid_argument
+     *             if it is raw or its header is invalid or unsupported
+     */
+    explicit sample_reader(const std::string &path);
+
+    /** Open a file of any type, format and channels of raw files are given.
+     *
+     * @param path path of the file, throws std::runtime_error if it cannot be opened and std::invalid_argument
+     *             if its header is invalid or unsupported (or the size of a raw file is not a multiple of the frame size)
+     * @param type container of the file
+     * @param format sample format of a raw file (ignored for the other types)
+     * @param n_channels interleaved channels of a raw file (ignored for the other types)
+     */
+    sample_reader(const std::string &path, file_type type, sample_format format, std::size_t n_channels);
+    ~sample_reader();
+
+    sample_reader(const sample_reader &) = delete;
+    sample_reader &operator=(const sample_reader &) = delete;
+
+    /** Get sample format of the file
+     *
+     * @return sample format
+     */
+    sample_format get_format() const { return m_format; }
+
+    /** Get number of channels
+     *
+     * @return number of channels
+     */
+    std::size_t get_channels() const { return m_n_channels; }
+
+    /** Get number of frames in the file
+     *
+     * @return number of frames
+     */
+    std::size_t get_frames() const { return m_n_frames; }
+
+    /** Get the sampling frequency (WAV only)
+     *
+     * @return sampling frequency in Hz, 0 if not stored in the file
+     */
+    double get_sampling_frequency() const { return m_sampling_frequency; }
+
+    /** Read the next frames.
+     *
+     * @param out output buffer (max_frames * channels samples, interleaved)
+     * @param max_frames maximum number of frames
+     * @return number of frames read, 0 at the end of the file (throws std::runtime_error if the file is truncated)
+     */
+    std::size_t read(double *out, std::size_t max_frames);
+
+    /** Read all remaining frames.
+     *
+     * @return interleaved samples
+     */
+    std::vector<double> read();
+};
+
+/** Writes interleaved frames to a raw, WAV or .npy file in chunks.
+ *
+ * WAV and .npy headers are written with placeholder sizes first and completed by close, so the number of
+ * frames does not need to be known in advance.
+ */
+class sample_writer
+{
+private:
+    std::FILE *m_file = nullptr;
+    std::string m_path;
+    file_type m_type;
+    sample_format m_format;
+    std::size_t m_n_channels;
+    double m_sampling_frequency;
+    std::size_t m_n_frames = 0;
+    std::vector<unsigned char> m_buffer;
+
+    void write_header();
+    void write_bytes(const void *data, std::size_t n);
+
+public:
+    // size of the .npy header (magic, version, length and padded dictionary)
+    static constexpr std::size_t NPY_HEADER_SIZE = 128;
+
+    /** Create (or truncate) a file.
+     *
+     * @param path path of the file, throws std::runtime_error if it cannot be created ("-" writes to the
+     *             standard output, raw samples only, throws std::invalid_argument for the other types)
+     * @param type container of the file
+     * @param format sample format
+     * @param n_channels interleaved channels (throws std::invalid_argument if 0)
+     * @param sampling_frequency sampling frequency stored in WAV headers (rounded to Hz)
+     */
+    sample_writer(const std::string &path, file_type type, sample_format format, std::size_t n_channels = 1, double sampling_frequency = 0);
+
+    /** Closes the file (see close), errors are ignored. */
+    ~sample_writer();
+
+    sample_writer(const sample_writer &) = delete;
+    sample_writer &operator=(const sample_writer &) = delete;
+
+    /** Get number of channels
+     *
+     * @return number of channels
+     */
+    std::size_t get_channels() const { return m_n_channels; }
+
+    /** Get number of frames written so far
+     *
+     * @return number of frames
+     */
+    std::size_t get_frames() const { return m_n_frames; }
+
+    /** Append frames.
+     *
+     * @param in interleaved samples (n_frames * channels)
+     * @param n_frames number of frames, throws std::runtime_error on write errors
+     */
+    void write(const double *in, std::size_t n_frames);
+
+    /** Append frames.
+     *
+     * @param samples interleaved samples (a multiple of the number of channels)
+     */
+    void write(const std::vector<double> &samples) { write(samples.data(), samples.size() / m_n_channels); }
+
+    /** Complete the header and close the file (the standard output is only flushed, further calls do nothing).
+     *
+     * Throws std::runtime_error on write errors.
+     */
+    void close();
+};
+
+#endif //!__SAMPLE_IO__H__
@@ -0,0 +1,212 @@
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "sample_io.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::vector<double> test_samples(std::size_t n, double amplitude)
+    {
+        std::vector<double> samples;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            samples.push_back(amplitude * std::sin(0.05 * i) * std::cos(0.0007 * i));
+        }
+        return samples;
+    }
+
+    std::vector<unsigned char> read_bytes(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<unsigned char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    void write_bytes(const std::string &path, const std::vector<unsigned char> &bytes)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+}
+
+TEST(sample_io_test, sample_format)
+{
+    EXPECT_EQ(sample_format::int16, parse_sample_format("s16"));
+    EXPECT_EQ(sample_format::int32, parse_sample_format("int32"));
+    EXPECT_EQ(sample_format::float32, parse_sample_format("float32"));
+    EXPECT_EQ(sample_format::float64, parse_sample_format("f64"));
+    EXPECT_THROW(parse_sample_format("u8"), std::invalid_argument);
+    EXPECT_EQ(2u, get_sample_size(sample_format::int16));
+    EXPECT_EQ(8u, get_sample_size(sample_format::float64));
+
+    EXPECT_EQ(file_type::wav, get_file_type("/data/take.1.WAV"));
+    EXPECT_EQ(file_type::npy, get_file_type("out.npy"));
+    EXPECT_EQ(file_type::raw, get_file_type("recording.f32"));
+    EXPECT_EQ(file_type::raw, get_file_type("recording"));
+}
+
+TEST(sample_io_test, encode)
+{
+    std::vector<double> samples{0.4, 0.6, -1.5, 40000, -40000, 1e12};
+    std::vector<std::int16_t> s16(samples.size());
+    encode_samples(sample_format::int16, samples.data(), s16.data(), samples.size());
+    EXPECT_EQ((std::vector<std::int16_t>{0, 1, -2, 32767, -32768, 32767}), s16);
+    std::vector<std::int32_t> s32(samples.size());
+    encode_samples(sample_format::int32, samples.data(), s32.data(), samples.size());
+    EXPECT_EQ((std::vector<std::int32_t>{0, 1, -2, 40000, -40000, 2147483647}), s32);
+
+    std::vector<double> decoded(samples.size());
+    decode_samples(sample_format::int16, s16.data(), decoded.data(), samples.size());
+    EXPECT_EQ((std::vector<double>{0, 1, -2, 32767, -32768, 32767}), decoded);
+}
+
+TEST(sample_io_test, round_trip)
+{
+    const std::size_t n_channels = 3;
+    const std::size_t n_frames = 1001;
+    const sample_format formats[] = {sample_format::int16, sample_format::int32, sample_format::float32, sample_format::float64};
+    const file_type types[] = {file_type::raw, file_type::wav, file_type::npy};
+    const std::string path = ::testing::TempDir() + "sample_io_round_trip";
+
+    for (file_type type : types)
+    {
+        for (sample_format format : formats)
+        {
+            double amplitude = format == sample_format::int16 ? 30000 : 1e6;
+            std::vector<double> samples(test_samples(n_frames * n_channels, amplitude));
+            std::vector<double> expected(samples.size());
+            std::vector<unsigned char> stored(samples.size() * get_sample_size(format));
+            encode_samples(format, samples.data(), stored.data(), samples.size());
+            decode_samples(format, stored.data(), expected.data(), samples.size());
+
+            // written and read in chunks of different size
+            {
+                sample_writer writer(path, type, format, n_channels, 44100);
+                for (std::size_t frame = 0; frame < n_frames; frame += 100)
+                {
+                    writer.write(samples.data() + frame * n_channels, std::min<std::size_t>(100, n_frames - frame));
+                }
+                EXPECT_EQ(n_frames, writer.get_frames());
+            }
+            sample_reader reader(path, type, format, n_channels);
+            EXPECT_EQ(format, reader.get_format());
+            EXPECT_EQ(n_channels, reader.get_channels());
+            EXPECT_EQ(n_frames, reader.get_frames());
+            EXPECT_EQ(type == file_type::wav ? 44100 : 0, reader.get_sampling_frequency());
+            std::vector<double> result(samples.size());
+            std::size_t n = 0;
+            while (std::size_t count = reader.read(result.data() + n * n_channels, 77))
+            {
+                n += count;
+            }
+            EXPECT_EQ(n_frames, n);
+            EXPECT_EQ(expected, result);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST(sample_io_test, standard_output)
+{
+    // "-" writes raw samples to the standard output, not to a file named "-"
+    std::remove("-");
+    std::vector<double> samples{1, -2, 300};
+    ::testing::internal::CaptureStdout();
+    {
+        sample_writer writer("-", file_type::raw, sample_format::int16);
+        writer.write(samples);
+        writer.close();
+    }
+    std::string output(::testing::internal::GetCapturedStdout());
+    std::vector<std::int16_t> expected{1, -2, 300};
+    EXPECT_EQ(std::string(reinterpret_cast<const char *>(expected.data()), expected.size() * sizeof(std::int16_t)), output);
+    EXPECT_FALSE(std::ifstream("-").good());
+
+    // headers cannot be completed on a pipe
+    EXPECT_THROW(sample_writer("-", file_type::npy, sample_format::int16), std::invalid_argument);
+    EXPECT_THROW(sample_writer("-", file_type::wav, sample_format::int16, 1, 44100), std::invalid_argument);
+}
+
+TEST(sample_io_test, headers)
+{
+    const std::string path = ::testing::TempDir() + "sample_io_headers";
+
+    // .npy: version 1.0 header padded to a multiple of 64 bytes, shape (frames,) for one channel
+    {
+        sample_writer writer(path, file_type::npy, sample_format::float32, 1);
+        writer.write(std::vector<double>{1, 2, 3});
+    }
+    std::vector<unsigned char> npy(read_bytes(path));
+    ASSERT_EQ(sample_writer::NPY_HEADER_SIZE + 12, npy.size());
+    std::string header(npy.begin() + 10, npy.begin() + sample_writer::NPY_HEADER_SIZE);
+    EXPECT_EQ(0u, sample_writer::NPY_HEADER_SIZE % 64);
+    EXPECT_EQ(0, header.find("{'descr': '<f4', 'fortran_order': False, 'shape': (3,), }"));
+    EXPECT_EQ('\n', header.back());
+
+    // WAV: 16 bit PCM with the canonical 44 byte header
+    {
+        sample_writer writer(path, file_type::wav, sample_format::int16, 2, 8000);
+        writer.write(std::vector<double>{1, -1, 2, -2});
+    }
+    std::vector<unsigned char> wav(read_bytes(path));
+    ASSERT_EQ(44u + 8, wav.size());
+    EXPECT_EQ(wav.size() - 8, wav[4]); // RIFF size
+    EXPECT_EQ(1, wav[20]);             // PCM
+    EXPECT_EQ(2, wav[22]);             // channels
+    EXPECT_EQ(8u, wav[40]);            // data size
+    EXPECT_EQ(0xFF, wav[46]);          // -1 little-endian
+    EXPECT_EQ(0xFF, wav[47]);
+
+    // a data chunk with an open size (streamed writers) extends to the end of the file
+    wav[40] = wav[41] = wav[42] = wav[43] = 0xFF;
+    write_bytes(path, wav);
+    EXPECT_EQ(2u, sample_reader(path, file_type::wav, sample_format::float64, 1).get_frames());
+
+    // Fortran order and 3 dimensions are not supported
+    std::string fortran("{'descr': '<i2', 'fortran_order': True, 'shape': (2, 2), }");
+    std::string cube("{'descr': '<i2', 'fortran_order': False, 'shape': (1, 2, 2), }");
+    for (const std::string &dictionary : {fortran, cube})
+    {
+        std::vector<unsigned char> bytes{0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0, static_cast<unsigned char>(dictionary.size()), 0};
+        bytes.insert(bytes.end(), dictionary.begin(), dictionary.end());
+        bytes.resize(bytes.size() + 8);
+        write_bytes(path, bytes);
+        EXPECT_THROW(sample_reader reader(path, file_type::npy, sample_format::float64, 1), std::invalid_argument);
+    }
+
+    // version 2.0 (4 byte header length) is read, unknown versions are rejected
+    {
+        std::string dictionary("{'descr': '<i2', 'fortran_order': False, 'shape': (3,), }");
+        dictionary.resize(128 - 12 - 1, ' ');
+        dictionary += '\n';
+        std::vector<unsigned char> bytes{0x93, 'N', 'U', 'M', 'P', 'Y', 2, 0, static_cast<unsigned char>(dictionary.size()), 0, 0, 0};
+        bytes.insert(bytes.end(), dictionary.begin(), dictionary.end());
+        for (std::int16_t sample : {1, -2, 300})
+        {
+            bytes.push_back(static_cast<unsigned char>(sample & 0xFF));
+            bytes.push_back(static_cast<unsigned char>((sample >> 8) & 0xFF));
+        }
+        write_bytes(path, bytes);
+        sample_reader reader(path, file_type::npy, sample_format::float64, 1);
+        EXPECT_EQ(sample_format::int16, reader.get_format());
+        EXPECT_EQ(3u, reader.get_frames());
+        EXPECT_EQ((std::vector<double>{1, -2, 300}), reader.read());
+
+        bytes[6] = 4;
+        write_bytes(path, bytes);
+        EXPECT_THROW(sample_reader reader(path, file_type::npy, sample_format::float64, 1), std::invalid_argument);
+    }
+
+    // raw files need format and channels, sizes must be a multiple of the frame size
+    EXPECT_THROW(sample_reader reader(path), std::invalid_argument);
+    EXPECT_THROW(sample_reader reader(path, file_type::raw, sample_format::float64, 3), std::invalid_argument);
+    EXPECT_THROW(sample_reader reader(path + ".missing.wav"), std::runtime_error);
+    EXPECT_THROW(sample_writer writer(path, file_type::wav, sample_format::int16, 1, 0), std::invalid_argument);
+    std::remove(path.c_str());
+}
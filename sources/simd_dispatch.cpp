@@ -0,0 +1,123 @@
+#include "simd_dispatch.h"
+#include "simd_kernels.h"
+#include "utils.h"
+
+#include <atomic>
+#include <stdexcept>
+
+namespace
+{
+    const simd::kernels *kernels_for(simd::instruction_set isa)
+    {
+        switch (isa)
+        {
+        case simd::instruction_set::generic:
+            return &simd::generic_kernels;
+#ifdef FILTERLIB_X86_KERNELS
+        case simd::instruction_set::avx2:
+            return &simd::avx2_kernels;
+        case simd::instruction_set::avx512:
+            return &simd::avx512_kernels;
+#endif //FILTERLIB_X86_KERNELS
+        default:
+            return nullptr;
+        }
+    }
+
+    bool cpu_supports(simd::instruction_set isa)
+    {
+        switch (isa)
+        {
+        case simd::instruction_set::generic:
+            return true;
+#ifdef FILTERLIB_X86_KERNELS
+        // CPUID (and XGETBV for the OS support of the register state), evaluated once by the runtime
+        case simd::instruction_set::avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case simd::instruction_set::avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma");
+#endif //FILTERLIB_X86_KERNELS
+        default:
+            return false;
+        }
+    }
+
+    const simd::kernels *best_kernels()
+    {
+        for (simd::instruction_set isa : {simd::instruction_set::avx512, simd::instruction_set::avx2})
+        {
+            if (simd::is_supported(isa))
+            {
+                return kernels_for(isa);
+            }
+        }
+        return &simd::generic_kernels;
+    }
+
+    std::atomic<const simd::kernels *> &active_kernels()
+    {
+        static std::atomic<const simd::kernels *> active{best_kernels()};
+        return active;
+    }
+
+    // select the kernels when the library is loaded instead of on the first call
+    const bool selected_on_load = (active_kernels(), true);
+} // namespace
+
+bool simd::is_supported(instruction_set isa)
+{
+    return kernels_for(isa) != nullptr && cpu_supports(isa);
+}
+
+std::vector<simd::instruction_set> simd::supported_instruction_sets()
+{
+    std::vector<instruction_set> result;
+    for (instruction_set isa : {instruction_set::generic, instruction_set::avx2, instruction_set::avx512})
+    {
+        if (is_supported(isa))
+        {
+            result.push_back(isa);
+        }
+    }
+    return result;
+}
+
+simd::instruction_set simd::get_instruction_set()
+{
+    return get_kernels().isa;
+}
+
+void simd::set_instruction_set(instruction_set isa)
+{
+    if (!is_supported(isa))
+    {
+        throw std::invalid_argument("Instruction set is not supported on this machine");
+    }
+    active_kernels().store(kernels_for(isa));
+    DEBUG_STREAM("SIMD kernels set to " << to_string(isa));
+}
+
+void simd::reset_instruction_set()
+{
+    active_kernels().store(best_kernels());
+    DEBUG_STREAM("SIMD kernels reset to " << to_string(get_instruction_set()));
+}
+
+const simd::kernels &simd::get_kernels()
+{
+    return *active_kernels().load();
+}
+
+const char *simd::to_string(instruction_set isa)
+{
+    switch (isa)
+    {
+    case instruction_set::generic:
+        return "generic";
+    case instruction_set::avx2:
+        return "avx2";
+    case instruction_set::avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
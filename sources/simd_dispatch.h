@@ -0,0 +1,150 @@
+#ifndef __SIMD_DISPATCH__H__
+#define __SIMD_DISPATCH__H__
+
+#include <cstddef>
+#include <vector>
+
+namespace simd
+{
+    /** Instruction sets the vectorized kernels are compiled for. */
+    enum class instruction_set
+    {
+        generic, // 128 bit vectors (SSE2 on x86-64, NEON on aarch64)
+        avx2,    // 256 bit vectors with FMA
+        avx512   // 512 bit vectors with FMA
+    };
+
+    /** Vectorized multichannel cascade kernel for samples of type T. */
+    template <typename T>
+    struct lane_kernel
+    {
+        // number of channels processed together by process
+        std::size_t lanes;
+
+        /** Push a tile of `lanes` channels through a cascade in transposed direct form 2.
+         *
+         * Sample i of the channel group is read from `in + i * in_stride` (`lanes` contiguous values) and
+         * written to `out + i * out_stride`. `in` and `out` may point to the same buffer.
+         *
+         * @param coefficients b0, b1, b2, a1, a2 per section
+         * @param n_sections number of sections
+         * @param state first lane of the state of the channel group ([section][s1, s2][channel])
+         * @param state_stride distance between the state arrays (padded number of channels)
+         * @param in input samples
+         * @param in_stride distance between consecutive samples of a channel in `in`
+         * @param out output samples
+         * @param out_stride distance between consecutive samples of a channel in `out`
+         * @param n number of samples (at most TILE_SIZE)
+         */
+        void (*process)(const T *coefficients, std::size_t n_sections, T *state, std::size_t state_stride,
+                        const T *in, std::size_t in_stride, T *out, std::size_t out_stride, std::size_t n);
+    };
+
+    /** Vectorized filter bank kernel for samples of type T (one input, a different cascade per lane). */
+    template <typename T>
+    struct bank_kernel
+    {
+        // number of bands processed together by process
+        std::size_t lanes;
+
+        /** Push a tile of one input signal through the cascades of `lanes` bands in transposed direct form 2.
+         *
+         * All bands of the group need the same number of sections.
+         *
+         * @param coefficients first lane of the coefficients of the band group ([section][b0, b1, b2, a1, a2][band])
+         * @param n_sections number of sections
+         * @param state first lane of the state of the band group ([section][s1, s2][band])
+         * @param stride distance between the coefficient arrays and between the state arrays (padded number of bands)
+         * @param in input samples (shared by all bands)
+         * @param out output samples, sample i of the group is written to `out + i * lanes` (or nullptr)
+         * @param energy sum of the squared outputs of the group (`lanes` values, accumulated) or nullptr
+         * @param n number of samples (at most TILE_SIZE)
+         */
+        void (*process)(const T *coefficients, std::size_t n_sections, T *state, std::size_t stride,
+                        const T *in, T *out, T *energy, std::size_t n);
+    };
+
+    /** Table of the vectorized kernels compiled for one instruction set. */
+    struct kernels
+    {
+        instruction_set isa;
+        lane_kernel<double> f64;
+        lane_kernel<float> f32;
+        bank_kernel<double> bank_f64;
+        bank_kernel<float> bank_f32;
+
+        /** Return the kernel for samples of type T.
+         *
+         * @return f64 or f32
+         */
+        template <typename T>
+        const lane_kernel<T> &get() const;
+
+        /** Return the filter bank kernel for samples of type T.
+         *
+         * @return bank_f64 or bank_f32
+         */
+        template <typename T>
+        const bank_kernel<T> &get_bank() const;
+    };
+
+    template <>
+    inline const lane_kernel<double> &kernels::get<double>() const { return f64; }
+    template <>
+    inline const lane_kernel<float> &kernels::get<float>() const { return f32; }
+    template <>
+    inline const bank_kernel<double> &kernels::get_bank<double>() const { return bank_f64; }
+    template <>
+    inline const bank_kernel<float> &kernels::get_bank<float>() const { return bank_f32; }
+
+    // size of the samples of one tile row of the widest kernel (lanes * sizeof(sample), for sizing buffers)
+    constexpr std::size_t MAX_LANE_BYTES = 256;
+    // number of samples per call of a kernel (the tile stays resident in L1 cache)
+    constexpr std::size_t TILE_SIZE = 64;
+
+    /** Test whether kernels for an instruction set are compiled in and supported by the CPU.
+     *
+     * @param isa instruction set
+     * @return true if the kernels can be used
+     */
+    bool is_supported(instruction_set isa);
+
+    /** Return all instruction sets that can be used on this machine.
+     *
+     * @return supported instruction sets, from generic to most specific
+     */
+    std::vector<instruction_set> supported_instruction_sets();
+
+    /** Return the instruction set of the kernels in use.
+     *
+     * Selected when the library is loaded (the best instruction set supported by the CPU) or
+     * with set_instruction_set.
+     *
+     * @return instruction set
+     */
+    instruction_set get_instruction_set();
+
+    /** Force the kernels of an instruction set. Objects that already selected their kernels keep them.
+     *
+     * @param isa instruction set, throws std::invalid_argument if not supported
+     */
+    void set_instruction_set(instruction_set isa);
+
+    /** Return to the best instruction set supported by the CPU. */
+    void reset_instruction_set();
+
+    /** Return the kernels in use.
+     *
+     * @return kernel table
+     */
+    const kernels &get_kernels();
+
+    /** Return the name of an instruction set.
+     *
+     * @param isa instruction set
+     * @return name ("generic", "avx2" or "avx512")
+     */
+    const char *to_string(instruction_set isa);
+} // namespace simd
+
+#endif //!__SIMD_DISPATCH__H__
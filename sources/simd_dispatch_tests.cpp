@@ -0,0 +1,97 @@
+#include "simd_dispatch.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+TEST(simd_dispatch_test, select)
+{
+    // the generic kernels are always available and the best instruction set is selected on load
+    std::vector<simd::instruction_set> supported(simd::supported_instruction_sets());
+    ASSERT_FALSE(supported.empty());
+    EXPECT_EQ(simd::instruction_set::generic, supported.front());
+    EXPECT_EQ(supported.back(), simd::get_instruction_set());
+
+    for (simd::instruction_set isa : supported)
+    {
+        EXPECT_TRUE(simd::is_supported(isa));
+        simd::set_instruction_set(isa);
+        EXPECT_EQ(isa, simd::get_instruction_set());
+        EXPECT_EQ(isa, simd::get_kernels().isa);
+        EXPECT_LE(simd::get_kernels().f64.lanes * sizeof(double), simd::MAX_LANE_BYTES);
+        EXPECT_LE(simd::get_kernels().f32.lanes * sizeof(float), simd::MAX_LANE_BYTES);
+    }
+
+    for (simd::instruction_set isa : {simd::instruction_set::avx2, simd::instruction_set::avx512})
+    {
+        if (!simd::is_supported(isa))
+        {
+            EXPECT_THROW(simd::set_instruction_set(isa), std::invalid_argument);
+        }
+    }
+
+    simd::reset_instruction_set();
+    EXPECT_EQ(supported.back(), simd::get_instruction_set());
+    EXPECT_EQ(std::string("avx2"), simd::to_string(simd::instruction_set::avx2));
+}
+
+template <typename T>
+void check_lane_kernel(const simd::lane_kernel<T> &kernel)
+{
+    // y[n] = 0.5 * x[n] + 0.25 * y[n-1] for all lanes (exact in float and double)
+    const T coefficients[5]{0.5, 0.0, 0.0, -0.25, 0.0};
+    std::size_t lanes = kernel.lanes;
+    std::vector<T> state(2 * lanes, 0);
+    std::vector<T> samples(3 * lanes, 1);
+
+    kernel.process(coefficients, 1, state.data(), lanes, samples.data(), lanes, samples.data(), lanes, 3);
+    for (std::size_t l = 0; l < lanes; l++)
+    {
+        EXPECT_EQ(T(0.5), samples[l]);
+        EXPECT_EQ(T(0.625), samples[lanes + l]);
+        EXPECT_EQ(T(0.65625), samples[2 * lanes + l]);
+    }
+}
+
+template <typename T>
+void check_bank_kernel(const simd::bank_kernel<T> &kernel)
+{
+    // y[n] = g * x[n] + 0.25 * y[n-1] with g = 0.5 for even and g = 1 for odd lanes (exact in float and double)
+    std::size_t lanes = kernel.lanes;
+    std::vector<T> coefficients(5 * lanes, 0);
+    for (std::size_t l = 0; l < lanes; l++)
+    {
+        coefficients[l] = (l % 2 == 0) ? T(0.5) : T(1);
+        coefficients[3 * lanes + l] = T(-0.25);
+    }
+    std::vector<T> state(2 * lanes, 0);
+    std::vector<T> samples(3, 1);
+    std::vector<T> out(3 * lanes);
+    std::vector<T> energy(lanes, 1);
+
+    kernel.process(coefficients.data(), 1, state.data(), lanes, samples.data(), out.data(), energy.data(), 3);
+    for (std::size_t l = 0; l < lanes; l++)
+    {
+        T g = (l % 2 == 0) ? T(1) : T(2);
+        EXPECT_EQ(g * T(0.5), out[l]);
+        EXPECT_EQ(g * T(0.625), out[lanes + l]);
+        EXPECT_EQ(g * T(0.65625), out[2 * lanes + l]);
+        EXPECT_EQ(1 + g * g * (T(0.25) + T(0.390625) + T(0.4306640625)), energy[l]);
+    }
+}
+
+TEST(simd_dispatch_test, kernels)
+{
+    for (simd::instruction_set isa : simd::supported_instruction_sets())
+    {
+        simd::set_instruction_set(isa);
+        const simd::kernels &kernels = simd::get_kernels();
+        EXPECT_EQ(2 * kernels.f64.lanes, kernels.f32.lanes);
+        check_lane_kernel(kernels.f64);
+        check_lane_kernel(kernels.f32);
+        EXPECT_EQ(2 * kernels.bank_f64.lanes, kernels.bank_f32.lanes);
+        check_bank_kernel(kernels.bank_f64);
+        check_bank_kernel(kernels.bank_f32);
+    }
+    simd::reset_instruction_set();
+}
@@ -0,0 +1,203 @@
+#ifndef __SIMD_KERNELS__H__
+#define __SIMD_KERNELS__H__
+
+// Internal header: the kernel templates are compiled once per instruction set (simd_kernels_<isa>.cpp).
+
+#include <cstddef>
+#include <cstring>
+#include "simd_dispatch.h"
+
+namespace simd
+{
+    extern const kernels generic_kernels;
+#ifdef FILTERLIB_X86_KERNELS
+    extern const kernels avx2_kernels;
+    extern const kernels avx512_kernels;
+#endif //FILTERLIB_X86_KERNELS
+} // namespace simd
+
+// Internal linkage: every translation unit gets its own copy compiled with its own instruction set flags,
+// so the linker cannot merge an AVX-512 instantiation into the generic kernels.
+namespace
+{
+    // SIMD registers per state word: the recursions of independent registers overlap in the pipeline
+    constexpr std::size_t SIMD_REGISTERS = 4;
+
+    // one SIMD register of V values of type T
+    template <typename T, std::size_t V>
+    using simd_vector_t __attribute__((vector_size(V * sizeof(T)))) = T;
+
+    /** Push a tile of V * R channels through the cascade (transposed direct form 2).
+     *
+     * See simd::lane_kernel::process.
+     */
+    template <typename T, std::size_t V, std::size_t R>
+    void simd_process_lanes(const T *coefficients, std::size_t n_sections, T *state, std::size_t state_stride,
+                            const T *in, std::size_t in_stride, T *out, std::size_t out_stride, std::size_t n)
+    {
+        using vector = simd_vector_t<T, V>;
+        constexpr std::size_t W = V * R;
+        static_assert(W * sizeof(T) <= simd::MAX_LANE_BYTES, "Increase simd::MAX_LANE_BYTES");
+
+        // gather the tile into a contiguous buffer (compile time size: vector moves)
+        alignas(64) T buffer[simd::TILE_SIZE * W];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            std::memcpy(buffer + i * W, in + i * in_stride, W * sizeof(T));
+        }
+
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            const T b0 = coefficients[5 * s + 0];
+            const T b1 = coefficients[5 * s + 1];
+            const T b2 = coefficients[5 * s + 2];
+            const T a1 = coefficients[5 * s + 3];
+            const T a2 = coefficients[5 * s + 4];
+            T *s1_state = state + 2 * s * state_stride;
+            T *s2_state = s1_state + state_stride;
+
+            // keep the state of the lanes in registers for the whole tile
+            vector s1[R], s2[R];
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(&s1[r], s1_state + r * V, sizeof(vector));
+                std::memcpy(&s2[r], s2_state + r * V, sizeof(vector));
+            }
+
+            for (std::size_t i = 0; i < n; i++)
+            {
+                for (std::size_t r = 0; r < R; r++)
+                {
+                    vector x;
+                    std::memcpy(&x, buffer + i * W + r * V, sizeof(vector));
+                    vector y = b0 * x + s1[r];
+                    s1[r] = b1 * x - a1 * y + s2[r];
+                    s2[r] = b2 * x - a2 * y;
+                    std::memcpy(buffer + i * W + r * V, &y, sizeof(vector));
+                }
+            }
+
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(s1_state + r * V, &s1[r], sizeof(vector));
+                std::memcpy(s2_state + r * V, &s2[r], sizeof(vector));
+            }
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            std::memcpy(out + i * out_stride, buffer + i * W, W * sizeof(T));
+        }
+    }
+
+    // SIMD registers per state word of the bank kernel (the coefficients of every band are kept in registers too)
+    constexpr std::size_t BANK_SIMD_REGISTERS = 2;
+
+    /** Push a tile of one input through the cascades of V * R bands (transposed direct form 2).
+     *
+     * See simd::bank_kernel::process.
+     */
+    template <typename T, std::size_t V, std::size_t R>
+    void simd_process_bands(const T *coefficients, std::size_t n_sections, T *state, std::size_t stride,
+                            const T *in, T *out, T *energy, std::size_t n)
+    {
+        using vector = simd_vector_t<T, V>;
+        constexpr std::size_t W = V * R;
+        static_assert(W * sizeof(T) <= simd::MAX_LANE_BYTES, "Increase simd::MAX_LANE_BYTES");
+
+        // every band starts from the same input
+        alignas(64) T buffer[simd::TILE_SIZE * W];
+        for (std::size_t i = 0; i < n; i++)
+        {
+            for (std::size_t w = 0; w < W; w++)
+            {
+                buffer[i * W + w] = in[i];
+            }
+        }
+
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            const T *c = coefficients + 5 * s * stride;
+            T *s1_state = state + 2 * s * stride;
+            T *s2_state = s1_state + stride;
+
+            // keep the coefficients and the state of the lanes in registers for the whole tile
+            vector b0[R], b1[R], b2[R], a1[R], a2[R], s1[R], s2[R];
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(&b0[r], c + 0 * stride + r * V, sizeof(vector));
+                std::memcpy(&b1[r], c + 1 * stride + r * V, sizeof(vector));
+                std::memcpy(&b2[r], c + 2 * stride + r * V, sizeof(vector));
+                std::memcpy(&a1[r], c + 3 * stride + r * V, sizeof(vector));
+                std::memcpy(&a2[r], c + 4 * stride + r * V, sizeof(vector));
+                std::memcpy(&s1[r], s1_state + r * V, sizeof(vector));
+                std::memcpy(&s2[r], s2_state + r * V, sizeof(vector));
+            }
+
+            for (std::size_t i = 0; i < n; i++)
+            {
+                for (std::size_t r = 0; r < R; r++)
+                {
+                    vector x;
+                    std::memcpy(&x, buffer + i * W + r * V, sizeof(vector));
+                    vector y = b0[r] * x + s1[r];
+                    s1[r] = b1[r] * x - a1[r] * y + s2[r];
+                    s2[r] = b2[r] * x - a2[r] * y;
+                    std::memcpy(buffer + i * W + r * V, &y, sizeof(vector));
+                }
+            }
+
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(s1_state + r * V, &s1[r], sizeof(vector));
+                std::memcpy(s2_state + r * V, &s2[r], sizeof(vector));
+            }
+        }
+
+        if (energy != nullptr)
+        {
+            vector sum[R];
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(&sum[r], energy + r * V, sizeof(vector));
+            }
+            for (std::size_t i = 0; i < n; i++)
+            {
+                for (std::size_t r = 0; r < R; r++)
+                {
+                    vector y;
+                    std::memcpy(&y, buffer + i * W + r * V, sizeof(vector));
+                    sum[r] += y * y;
+                }
+            }
+            for (std::size_t r = 0; r < R; r++)
+            {
+                std::memcpy(energy + r * V, &sum[r], sizeof(vector));
+            }
+        }
+
+        if (out != nullptr)
+        {
+            std::memcpy(out, buffer, n * W * sizeof(T));
+        }
+    }
+
+    /** Kernel table for SIMD registers of the given size.
+     *
+     * @param isa instruction set the translation unit is compiled for
+     * @return kernel table
+     */
+    template <std::size_t VECTOR_BYTES>
+    constexpr simd::kernels make_kernels(simd::instruction_set isa)
+    {
+        constexpr std::size_t V64 = VECTOR_BYTES / sizeof(double);
+        constexpr std::size_t V32 = VECTOR_BYTES / sizeof(float);
+        return simd::kernels{isa,
+                             {V64 * SIMD_REGISTERS, &simd_process_lanes<double, V64, SIMD_REGISTERS>},
+                             {V32 * SIMD_REGISTERS, &simd_process_lanes<float, V32, SIMD_REGISTERS>},
+                             {V64 * BANK_SIMD_REGISTERS, &simd_process_bands<double, V64, BANK_SIMD_REGISTERS>},
+                             {V32 * BANK_SIMD_REGISTERS, &simd_process_bands<float, V32, BANK_SIMD_REGISTERS>}};
+    }
+} // namespace
+
+#endif //!__SIMD_KERNELS__H__
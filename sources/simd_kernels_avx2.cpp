@@ -0,0 +1,6 @@
+// Compiled with -mavx2 -mfma (see CMakeLists.txt), only called if the CPU supports AVX2 and FMA.
+#include "simd_kernels.h"
+
+#ifdef FILTERLIB_X86_KERNELS
+const simd::kernels simd::avx2_kernels = make_kernels<32>(simd::instruction_set::avx2);
+#endif //FILTERLIB_X86_KERNELS
@@ -0,0 +1,6 @@
+// Compiled with -mavx512f -mfma (see CMakeLists.txt), only called if the CPU supports AVX-512F.
+#include "simd_kernels.h"
+
+#ifdef FILTERLIB_X86_KERNELS
+const simd::kernels simd::avx512_kernels = make_kernels<64>(simd::instruction_set::avx512);
+#endif //FILTERLIB_X86_KERNELS
@@ -0,0 +1,4 @@
+// Compiled without additional instruction set flags (128 bit vectors: SSE2 on x86-64, NEON on aarch64).
+#include "simd_kernels.h"
+
+const simd::kernels simd::generic_kernels = make_kernels<16>(simd::instruction_set::generic);
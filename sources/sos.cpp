@@ -0,0 +1,134 @@
+#include "sos.h"
+#include "biquad_step.h"
+
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+
+template <typename C>
+void sos_coefficients<C>::aligned_delete::operator()(C *p) const
+{
+    ::operator delete[](p, std::align_val_t(ALIGNMENT));
+}
+
+template <typename C>
+template <typename T, typename D>
+sos_coefficients<C>::sos_coefficients(const std::vector<basic_biquad<T, D>> &sections, biquad_structure structure)
+    : m_n_sections(sections.size()),
+      m_structure(structure),
+      m_values(static_cast<C *>(::operator new[](std::max<std::size_t>(1, 5 * sections.size()) * sizeof(C), std::align_val_t(ALIGNMENT))))
+{
+    C *values = m_values.get();
+    for (const basic_biquad<T, D> &section : sections)
+    {
+        // round to C first, so the realization coefficients equal those of basic_biquad<T, C>
+        basic_biquad<C, C> rounded(static_cast<C>(section.m_b0), static_cast<C>(section.m_b1), static_cast<C>(section.m_b2),
+                                   static_cast<C>(section.m_a1), static_cast<C>(section.m_a2), structure);
+        const bool lattice = structure == biquad_structure::lattice;
+        *values++ = lattice ? rounded.m_k1 : rounded.m_b0;
+        *values++ = lattice ? rounded.m_k2 : rounded.m_b1;
+        *values++ = lattice ? rounded.m_v0 : rounded.m_b2;
+        *values++ = lattice ? rounded.m_v1 : rounded.m_a1;
+        *values++ = lattice ? rounded.m_b2 : rounded.m_a2;
+        std::vector<C> direct_form(rounded.get_coefficients());
+        m_direct_form.insert(m_direct_form.end(), direct_form.begin(), direct_form.end());
+    }
+}
+
+template <typename C>
+std::size_t sos_coefficients<C>::get_state_size() const
+{
+    return (m_structure == biquad_structure::direct_form_1 ? 4 : 2) * m_n_sections;
+}
+
+template <typename C>
+std::vector<C> sos_coefficients<C>::get_coefficients(std::size_t section) const
+{
+    if (section >= m_n_sections)
+    {
+        throw std::invalid_argument("Section index out of range");
+    }
+    return std::vector<C>(m_direct_form.begin() + 5 * section, m_direct_form.begin() + 5 * section + 5);
+}
+
+template <typename C>
+template <typename T>
+void sos_coefficients<C>::process(sos_state<C> &state, const T *in, T *out, std::size_t n) const
+{
+    if (state.get_state_size() != get_state_size())
+    {
+        throw std::invalid_argument("State does not fit the coefficients");
+    }
+    if (m_n_sections == 0)
+    {
+        std::copy(in, in + n, out);
+        return;
+    }
+
+    // packed state: 4 words per section for direct form 1, 2 otherwise
+    const std::size_t words = m_structure == biquad_structure::direct_form_1 ? 4 : 2;
+    const C *c = m_values.get();
+    C *z = state.data();
+    auto structure = [this](std::size_t)
+    { return m_structure; };
+    auto load = [c, z, words](std::size_t s, C(&coefficients)[5], C(&delay)[4])
+    {
+        std::copy(c + 5 * s, c + 5 * s + 5, coefficients);
+        std::copy(z + words * s, z + words * s + words, delay);
+    };
+    auto store = [z, words](std::size_t s, const C(&delay)[4])
+    {
+        std::copy(delay, delay + words, z + words * s);
+    };
+    process_fused_cascade<C>(m_n_sections, structure, load, store, in, out, n);
+}
+
+template <typename C>
+template <typename T>
+T sos_coefficients<C>::process(sos_state<C> &state, T sample) const
+{
+    T y = 0;
+    process(state, &sample, &y, 1);
+    return y;
+}
+
+template <typename C>
+sos_state<C>::sos_state(const sos_coefficients<C> &coefficients)
+    : m_state(coefficients.get_state_size(), C(0))
+{
+}
+
+template <typename C>
+void sos_state<C>::set_state(const std::vector<C> &state)
+{
+    if (state.size() != m_state.size())
+    {
+        throw std::invalid_argument("State size does not match the coefficients");
+    }
+    m_state = state;
+}
+
+template <typename C>
+void sos_state<C>::reset()
+{
+    std::fill(m_state.begin(), m_state.end(), C(0));
+}
+
+template class sos_coefficients<double>;
+template class sos_coefficients<float>;
+template class sos_state<double>;
+template class sos_state<float>;
+
+template sos_coefficients<double>::sos_coefficients(const std::vector<basic_biquad<double, double>> &, biquad_structure);
+template sos_coefficients<double>::sos_coefficients(const std::vector<basic_biquad<float, double>> &, biquad_structure);
+template sos_coefficients<double>::sos_coefficients(const std::vector<basic_biquad<float, float>> &, biquad_structure);
+template sos_coefficients<float>::sos_coefficients(const std::vector<basic_biquad<double, double>> &, biquad_structure);
+template sos_coefficients<float>::sos_coefficients(const std::vector<basic_biquad<float, double>> &, biquad_structure);
+template sos_coefficients<float>::sos_coefficients(const std::vector<basic_biquad<float, float>> &, biquad_structure);
+
+template double sos_coefficients<double>::process(sos_state<double> &, double) const;
+template float sos_coefficients<double>::process(sos_state<double> &, float) const;
+template float sos_coefficients<float>::process(sos_state<float> &, float) const;
+template void sos_coefficients<double>::process(sos_state<double> &, const double *, double *, std::size_t) const;
+template void sos_coefficients<double>::process(sos_state<double> &, const float *, float *, std::size_t) const;
+template void sos_coefficients<float>::process(sos_state<float> &, const float *, float *, std::size_t) const;
@@ -0,0 +1,143 @@
+#ifndef __SOS__H__
+#define __SOS__H__
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include "biquad.h"
+
+template <typename C>
+class sos_state;
+
+/** Immutable coefficients of a cascade of second order sections, shared by any number of streams.
+ *
+ * @tparam C type of the coefficients and the state (float or double), explicitly instantiated for both
+ *
+ * The coefficients of all sections are stored once in a contiguous, cache line aligned block (in the form
+ * used by the structure, e.g. the lattice coefficients), the delay lines live in one sos_state per stream.
+ * All methods are const, so one object can be used by many threads at the same time.
+ */
+template <typename C>
+class sos_coefficients
+{
+private:
+    struct aligned_delete
+    {
+        void operator()(C *p) const;
+    };
+
+    std::size_t m_n_sections;
+    biquad_structure m_structure;
+    std::unique_ptr<C[], aligned_delete> m_values; // realization coefficients, 5 per section
+    std::vector<C> m_direct_form;                  // b0, b1, b2, a1, a2 per section
+
+public:
+    // alignment of the coefficient block (cache line)
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    /** Create the coefficients of a cascade.
+     *
+     * @param sections second order sections (e.g. butterworth::get_sections or filter_design::butter),
+     *                 only their coefficients are used
+     * @param structure realization of the sections (the lattice requires |a2| < 1 for every section)
+     */
+    template <typename T, typename D>
+    explicit sos_coefficients(const std::vector<basic_biquad<T, D>> &sections,
+                              biquad_structure structure = biquad_structure::direct_form_1);
+
+    /** Get number of second order sections
+     *
+     * @return number of sections
+     */
+    std::size_t get_sections() const { return m_n_sections; }
+
+    /** Get the realization of the sections
+     *
+     * @return structure
+     */
+    biquad_structure get_structure() const { return m_structure; }
+
+    /** Get number of state words of a stream (4 per section for direct form 1, 2 otherwise)
+     *
+     * @return number of state words
+     */
+    std::size_t get_state_size() const;
+
+    /** Return filter coefficients of a section.
+     *
+     * @param section index of the section
+     * @return vector of coefficients (b0, b1, b2, a1, a2)
+     */
+    std::vector<C> get_coefficients(std::size_t section) const;
+
+    /** Process a single sample of a stream.
+     *
+     * @param state state of the stream, throws std::invalid_argument if it does not fit the coefficients
+     * @param sample single signal sample
+     * @return processed sample
+     */
+    template <typename T>
+    T process(sos_state<C> &state, T sample) const;
+
+    /** Process a block of samples of a stream without allocating memory (fused over the sections like
+     * basic_biquad::process_cascade, identical results).
+     *
+     * `in` and `out` may point to the same buffer.
+     *
+     * @param state state of the stream, throws std::invalid_argument if it does not fit the coefficients
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    template <typename T>
+    void process(sos_state<C> &state, const T *in, T *out, std::size_t n) const;
+};
+
+/** Delay lines of one stream filtered with shared sos_coefficients.
+ *
+ * @tparam C type of the state (float or double), explicitly instantiated for both
+ *
+ * Holds only the state words used by the structure (get_state_size() of the coefficients).
+ */
+template <typename C>
+class sos_state
+{
+private:
+    std::vector<C> m_state;
+
+public:
+    /** Create a zero state for a cascade.
+     *
+     * @param coefficients coefficients the state is used with
+     */
+    explicit sos_state(const sos_coefficients<C> &coefficients);
+
+    /** Get number of state words
+     *
+     * @return number of state words
+     */
+    std::size_t get_state_size() const { return m_state.size(); }
+
+    /** Return the state words (section by section, see basic_biquad::get_state).
+     *
+     * @return state words
+     */
+    const std::vector<C> &get_state() const { return m_state; }
+
+    /** Restore the state words (see get_state).
+     *
+     * @param state state words, throws std::invalid_argument if the size does not match
+     */
+    void set_state(const std::vector<C> &state);
+
+    /** Reset the state to zero. */
+    void reset();
+
+    /** Get the state words for processing
+     *
+     * @return first state word
+     */
+    C *data() { return m_state.data(); }
+};
+
+#endif //!__SOS__H__
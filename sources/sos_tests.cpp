@@ -0,0 +1,92 @@
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+#include "butterworth.h"
+#include "sos.h"
+
+#include "gtest/gtest.h"
+
+TEST(sos_test, process)
+{
+    std::vector<double> signal;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+
+    for (biquad_structure structure : {biquad_structure::direct_form_1,
+                                       biquad_structure::transposed_direct_form_2,
+                                       biquad_structure::lattice})
+    {
+        // identical to the fused cascade of butterworth
+        butterworth reference{10, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50, structure};
+        std::shared_ptr<const sos_coefficients<double>> coefficients(reference.get_sos_coefficients());
+        std::vector<double> expected(reference.process(signal));
+        EXPECT_EQ(10u, coefficients->get_sections());
+        EXPECT_EQ(structure, coefficients->get_structure());
+        EXPECT_EQ(reference.get_state_size(), coefficients->get_state_size());
+
+        // two streams share the coefficients, one block-wise and in-place, one sample by sample
+        sos_state<double> block(*coefficients);
+        sos_state<double> sample(*coefficients);
+        EXPECT_EQ(coefficients->get_state_size(), block.get_state_size());
+        std::vector<double> result(signal);
+        coefficients->process(block, result.data(), result.data(), 300);
+        coefficients->process(block, result.data() + 300, result.data() + 300, result.size() - 300);
+        for (size_t i = 0; i < signal.size(); i++)
+        {
+            EXPECT_EQ(expected[i], result[i]);
+            EXPECT_EQ(expected[i], coefficients->process(sample, signal[i]));
+        }
+        EXPECT_EQ(reference.get_state(), block.get_state());
+
+        // restore and reset
+        sos_state<double> restored(*coefficients);
+        restored.set_state(block.get_state());
+        EXPECT_EQ(block.get_state(), restored.get_state());
+        restored.reset();
+        EXPECT_EQ(std::vector<double>(restored.get_state_size(), 0.0), restored.get_state());
+        EXPECT_THROW(restored.set_state(std::vector<double>(3, 0.0)), std::invalid_argument);
+    }
+
+    // the direct form coefficients are kept for every structure
+    butterworth reference{4, std::vector<double>{15, 20}, filter_design::filter_type::bandstop, 50};
+    sos_coefficients<double> coefficients(reference.get_sections());
+    EXPECT_EQ(reference.get_sections()[1].get_coefficients(), coefficients.get_coefficients(1));
+    EXPECT_THROW(coefficients.get_coefficients(4), std::invalid_argument);
+
+    // a state only fits coefficients with the same number of state words
+    sos_coefficients<double> lattice(reference.get_sections(), biquad_structure::lattice);
+    sos_state<double> state(lattice);
+    double sample = 1.0;
+    EXPECT_THROW(coefficients.process(state, &sample, &sample, 1), std::invalid_argument);
+}
+
+TEST(sos_test, sample_type)
+{
+    // float coefficients and samples, float samples with double coefficients
+    std::vector<float> signal;
+    for (int i = 0; i < 500; i++)
+    {
+        signal.push_back(static_cast<float>(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i)));
+    }
+
+    basic_butterworth<float> single{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    basic_butterworth<float, double> mixed{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::shared_ptr<const sos_coefficients<float>> single_coefficients(single.get_sos_coefficients());
+    std::shared_ptr<const sos_coefficients<double>> mixed_coefficients(mixed.get_sos_coefficients());
+    sos_state<float> single_state(*single_coefficients);
+    sos_state<double> mixed_state(*mixed_coefficients);
+
+    std::vector<float> single_result(signal.size());
+    std::vector<float> mixed_result(signal.size());
+    single_coefficients->process(single_state, signal.data(), single_result.data(), signal.size());
+    mixed_coefficients->process(mixed_state, signal.data(), mixed_result.data(), signal.size());
+    EXPECT_EQ(single.process(signal), single_result);
+    EXPECT_EQ(mixed.process(signal), mixed_result);
+
+    // the double design can be rounded to float coefficients directly
+    sos_coefficients<float> rounded(filter_design::butter(8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50));
+    EXPECT_EQ(single_coefficients->get_coefficients(2), rounded.get_coefficients(2));
+}
@@ -0,0 +1,137 @@
+#ifndef __SPSC_RING__H__
+#define __SPSC_RING__H__
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/** Lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * @tparam T element type (copy assignable)
+ *
+ * push is only called by the producer, pop only by the consumer, the other methods by any thread. The write
+ * and read positions live on separate cache lines, each side keeps a cached copy of the position of the other
+ * side and only reloads it (acquire) when the cached value says the ring is full or empty, so a transfer of a
+ * block costs two atomic operations on the shared positions.
+ */
+template <typename T>
+class spsc_ring
+{
+private:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    std::vector<T> m_buffer;
+    std::size_t m_mask; // capacity - 1 (capacity is a power of two)
+
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_write{0}; // elements written (producer)
+    std::size_t m_cached_read = 0;                            // producer's copy of m_read
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_read{0};  // elements read (consumer)
+    std::size_t m_cached_write = 0;                           // consumer's copy of m_write
+
+    static std::size_t round_capacity(std::size_t capacity)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("Ring capacity must be at least 1");
+        }
+        std::size_t rounded = 1;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+public:
+    /** Create an empty ring.
+     *
+     * @param capacity minimum number of elements, rounded up to a power of two (throws std::invalid_argument if 0)
+     */
+    explicit spsc_ring(std::size_t capacity) : m_buffer(round_capacity(capacity)), m_mask(m_buffer.size() - 1)
+    {
+    }
+
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring &operator=(const spsc_ring &) = delete;
+
+    /** Get number of elements the ring can hold
+     *
+     * @return capacity
+     */
+    std::size_t get_capacity() const { return m_buffer.size(); }
+
+    /** Get number of elements in the ring (a snapshot if the other side is active)
+     *
+     * @return number of elements
+     */
+    std::size_t get_size() const
+    {
+        // read position first: the write position loaded after it is never behind it, and the producer may
+        // have advanced past a full ring since, so the difference is clamped to the capacity
+        std::size_t read = m_read.load(std::memory_order_acquire);
+        std::size_t write = m_write.load(std::memory_order_acquire);
+        return std::min(write - read, m_buffer.size());
+    }
+
+    /** Append elements (producer only), as many as fit.
+     *
+     * @param values elements
+     * @param n number of elements
+     * @return number of elements appended (less than n if the ring is full)
+     */
+    std::size_t push(const T *values, std::size_t n)
+    {
+        std::size_t write = m_write.load(std::memory_order_relaxed);
+        if (m_buffer.size() - (write - m_cached_read) < n)
+        {
+            m_cached_read = m_read.load(std::memory_order_acquire);
+        }
+        n = std::min(n, m_buffer.size() - (write - m_cached_read));
+        for (std::size_t i = 0; i < n; i++)
+        {
+            m_buffer[(write + i) & m_mask] = values[i];
+        }
+        m_write.store(write + n, std::memory_order_release);
+        return n;
+    }
+
+    /** Append an element (producer only).
+     *
+     * @param value element
+     * @return false if the ring is full
+     */
+    bool push(const T &value) { return push(&value, 1) == 1; }
+
+    /** Remove the oldest elements (consumer only), as many as available.
+     *
+     * @param values output buffer
+     * @param n maximum number of elements
+     * @return number of elements removed
+     */
+    std::size_t pop(T *values, std::size_t n)
+    {
+        std::size_t read = m_read.load(std::memory_order_relaxed);
+        if (m_cached_write - read < n)
+        {
+            m_cached_write = m_write.load(std::memory_order_acquire);
+        }
+        n = std::min(n, m_cached_write - read);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            values[i] = m_buffer[(read + i) & m_mask];
+        }
+        m_read.store(read + n, std::memory_order_release);
+        return n;
+    }
+
+    /** Remove the oldest element (consumer only).
+     *
+     * @param value output
+     * @return false if the ring is empty
+     */
+    bool pop(T &value) { return pop(&value, 1) == 1; }
+};
+
+#endif //!__SPSC_RING__H__
@@ -0,0 +1,94 @@
+#include <vector>
+#include <thread>
+#include <numeric>
+
+#include "spsc_ring.h"
+
+#include "gtest/gtest.h"
+
+TEST(spsc_ring_test, push_pop)
+{
+    spsc_ring<int> ring(5);
+    EXPECT_EQ(8u, ring.get_capacity());
+    EXPECT_EQ(0u, ring.get_size());
+
+    // wrap around the end of the buffer several times
+    std::vector<int> values(6);
+    std::vector<int> out(8);
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 10; round++)
+    {
+        std::iota(values.begin(), values.end(), next);
+        ASSERT_EQ(6u, ring.push(values.data(), values.size()));
+        next += 6;
+        EXPECT_EQ(6u, ring.get_size());
+        ASSERT_EQ(6u, ring.pop(out.data(), out.size()));
+        for (std::size_t i = 0; i < 6; i++)
+        {
+            EXPECT_EQ(expected++, out[i]);
+        }
+    }
+
+    // partial push when full, partial pop when empty
+    std::vector<int> many(10, 7);
+    EXPECT_EQ(8u, ring.push(many.data(), many.size()));
+    EXPECT_FALSE(ring.push(1));
+    int value = 0;
+    EXPECT_TRUE(ring.pop(value));
+    EXPECT_EQ(7, value);
+    EXPECT_TRUE(ring.push(1));
+    EXPECT_EQ(8u, ring.pop(out.data(), 10));
+    EXPECT_EQ(1, out[7]);
+    EXPECT_FALSE(ring.pop(value));
+
+    EXPECT_THROW(spsc_ring<int>(0), std::invalid_argument);
+}
+
+TEST(spsc_ring_test, threads)
+{
+    // the consumer sees every element exactly once and in order
+    const std::size_t n = 200000;
+    spsc_ring<std::size_t> ring(64);
+    std::thread producer([&ring, n]()
+                         {
+                             std::size_t block[7];
+                             for (std::size_t next = 0; next < n;)
+                             {
+                                 std::size_t count = std::min<std::size_t>(7, n - next);
+                                 for (std::size_t i = 0; i < count; i++)
+                                 {
+                                     block[i] = next + i;
+                                 }
+                                 std::size_t pushed = 0;
+                                 while (pushed < count)
+                                 {
+                                     pushed += ring.push(block + pushed, count - pushed);
+                                     if (pushed < count)
+                                     {
+                                         std::this_thread::yield();
+                                     }
+                                 }
+                                 next += count;
+                             } });
+
+    std::vector<std::size_t> out(13);
+    std::size_t expected = 0;
+    bool in_order = true;
+    while (expected < n)
+    {
+        std::size_t count = ring.pop(out.data(), out.size());
+        if (count == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            in_order = in_order && out[i] == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(0u, ring.get_size());
+}
@@ -0,0 +1,97 @@
+#ifndef __STATIC_BUTTERWORTH__H__
+#define __STATIC_BUTTERWORTH__H__
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include "filter_design.h"
+#include "static_design.h"
+
+/** Butterworth filter with a configuration fixed at compile time.
+ *
+ * The second order sections are designed at compile time (see static_design::butter) and the cascade is
+ * fully unrolled, the coefficients are immediate constants in the generated code. Use it for fixed
+ * configurations (e.g. a DC blocker at a known sampling rate), butterworth for everything else.
+ *
+ * @tparam Order order of the filter
+ * @tparam Type type of the filter
+ * @tparam Spec struct with the critical frequencies `static constexpr double freq[]` (one for lowpass and
+ *              highpass, two for bandpass and bandstop) and `static constexpr double sampling_frequency`
+ *              (C++17 does not allow double template parameters)
+ * @tparam T type of the samples, the state and the coefficients (direct form 1)
+ *
+ * Example:
+ *   struct hum { static constexpr double freq[] = {45, 55}; static constexpr double sampling_frequency = 1000; };
+ *   static_butterworth<4, filter_design::filter_type::bandstop, hum> filter;
+ */
+template <int Order, filter_design::filter_type Type, typename Spec, typename T = double>
+class static_butterworth
+{
+public:
+    // number of second order sections
+    static constexpr std::size_t n_sections = static_design::n_sections(Order, Type);
+
+    // coefficients (b0, b1, b2, a1, a2) of the sections, designed at compile time
+    static constexpr std::array<std::array<double, 5>, n_sections> sections =
+        static_design::butter<Order, Type>(Spec::freq, Spec::sampling_frequency);
+
+private:
+    std::array<std::array<T, 4>, n_sections> m_state{}; // x[n-1], x[n-2], y[n-1], y[n-2] per section
+
+    template <std::size_t S>
+    T process_section(T x)
+    {
+        constexpr T b0 = static_cast<T>(sections[S][0]);
+        constexpr T b1 = static_cast<T>(sections[S][1]);
+        constexpr T b2 = static_cast<T>(sections[S][2]);
+        constexpr T a1 = static_cast<T>(sections[S][3]);
+        constexpr T a2 = static_cast<T>(sections[S][4]);
+        std::array<T, 4> &z = m_state[S];
+        T y = b0 * x + b1 * z[0] + b2 * z[1] - a1 * z[2] - a2 * z[3];
+        z[1] = z[0];
+        z[0] = x;
+        z[3] = z[2];
+        z[2] = y;
+        return y;
+    }
+
+    template <std::size_t... S>
+    T process_cascade(T x, std::index_sequence<S...>)
+    {
+        ((x = process_section<S>(x)), ...);
+        return x;
+    }
+
+public:
+    /** Process a single sample.
+     *
+     * @param sample single signal sample
+     * @return processed sample
+     */
+    T process(T sample)
+    {
+        return process_cascade(sample, std::make_index_sequence<n_sections>());
+    }
+
+    /** Process a block of samples (`in` and `out` may point to the same buffer).
+     *
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    void process(const T *in, T *out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; i++)
+        {
+            out[i] = process(in[i]);
+        }
+    }
+
+    /** Reset the state of all sections to zero. */
+    void reset()
+    {
+        m_state = {};
+    }
+};
+
+#endif //!__STATIC_BUTTERWORTH__H__
@@ -0,0 +1,131 @@
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#include "butterworth.h"
+#include "filter_design.h"
+#include "static_butterworth.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    struct lowpass_spec
+    {
+        static constexpr double freq[] = {15};
+        static constexpr double sampling_frequency = 50;
+    };
+
+    struct highpass_spec
+    {
+        static constexpr double freq[] = {0.5};
+        static constexpr double sampling_frequency = 48;
+    };
+
+    struct band_spec
+    {
+        static constexpr double freq[] = {10, 15};
+        static constexpr double sampling_frequency = 50;
+    };
+
+    struct narrow_band_spec
+    {
+        static constexpr double freq[] = {45, 55};
+        static constexpr double sampling_frequency = 1000;
+    };
+
+    // designed at compile time
+    constexpr auto lowpass_sections = static_design::butter<7, filter_design::filter_type::lowpass>(lowpass_spec::freq, lowpass_spec::sampling_frequency);
+    static_assert(lowpass_sections.size() == 4, "odd orders add a first order section");
+    static_assert(lowpass_sections[0][3] > -2 && lowpass_sections[0][3] < 2, "stable first section");
+
+    /** Compare the compile time design with filter_design::butter. */
+    template <int Order, filter_design::filter_type Type, typename Spec>
+    void check_design(bool same_pairing)
+    {
+        const double EPSILON = 1.0e-12;
+        SCOPED_TRACE(testing::Message() << "order " << Order << ", type " << static_cast<int>(Type));
+
+        std::vector<double> freq(std::begin(Spec::freq), std::end(Spec::freq));
+        std::vector<biquad> expected(filter_design::butter(Order, freq, Type, Spec::sampling_frequency));
+        constexpr auto sections = static_design::butter<Order, Type>(Spec::freq, Spec::sampling_frequency);
+        ASSERT_EQ(expected.size(), sections.size());
+
+        std::vector<biquad> result;
+        for (std::size_t s = 0; s < sections.size(); s++)
+        {
+            result.emplace_back(sections[s][0], sections[s][1], sections[s][2], sections[s][3], sections[s][4]);
+            std::vector<double> coefficients(expected[s].get_coefficients());
+            for (std::size_t i = 0; same_pairing && i < 5; i++)
+            {
+                EXPECT_NEAR(coefficients[i], sections[s][i], EPSILON * std::max(1.0, std::abs(coefficients[i])));
+            }
+        }
+
+        // the cascades are the same filter, even if the zeros are paired differently
+        std::vector<double> impulse(200, 0.0);
+        impulse[0] = 1;
+        std::vector<double> expected_response(impulse.size());
+        std::vector<double> response(impulse.size());
+        biquad::process_cascade(expected.data(), expected.size(), impulse.data(), expected_response.data(), impulse.size());
+        biquad::process_cascade(result.data(), result.size(), impulse.data(), response.data(), impulse.size());
+        for (std::size_t i = 0; i < impulse.size(); i++)
+        {
+            EXPECT_NEAR(expected_response[i], response[i], EPSILON);
+        }
+    }
+} // namespace
+
+TEST(static_butterworth_test, design)
+{
+    // poles of the band filters centered at fs/4 are (up to rounding) equally close to the unit circle,
+    // which of them is paired first depends on the last bits
+    check_design<1, filter_design::filter_type::lowpass, lowpass_spec>(true);
+    check_design<7, filter_design::filter_type::lowpass, lowpass_spec>(true);
+    check_design<8, filter_design::filter_type::lowpass, lowpass_spec>(true);
+    check_design<3, filter_design::filter_type::highpass, highpass_spec>(true);
+    check_design<6, filter_design::filter_type::highpass, highpass_spec>(true);
+    check_design<5, filter_design::filter_type::bandpass, band_spec>(false);
+    check_design<8, filter_design::filter_type::bandpass, band_spec>(false);
+    check_design<3, filter_design::filter_type::bandstop, band_spec>(false);
+    check_design<6, filter_design::filter_type::bandstop, band_spec>(false);
+    check_design<4, filter_design::filter_type::bandpass, narrow_band_spec>(true);
+    check_design<5, filter_design::filter_type::bandstop, narrow_band_spec>(true);
+}
+
+TEST(static_butterworth_test, process)
+{
+    const double EPSILON = 1.0e-12;
+
+    std::vector<double> signal;
+    for (int i = 0; i < 1000; i++)
+    {
+        signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+    }
+
+    butterworth reference{6, std::vector<double>{10, 15}, filter_design::filter_type::bandstop, 50};
+    std::vector<double> expected(reference.process(signal));
+
+    static_butterworth<6, filter_design::filter_type::bandstop, band_spec> filter;
+    EXPECT_EQ(6u, filter.n_sections);
+    std::vector<double> result(signal.size());
+    filter.process(signal.data(), result.data(), 500);
+    for (std::size_t i = 500; i < signal.size(); i++)
+    {
+        result[i] = filter.process(signal[i]);
+    }
+    for (std::size_t i = 0; i < signal.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], result[i], EPSILON);
+    }
+
+    // single precision
+    static_butterworth<6, filter_design::filter_type::bandstop, band_spec, float> single;
+    for (std::size_t i = 0; i < signal.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], single.process(static_cast<float>(signal[i])), 1.0e-4);
+    }
+
+    filter.reset();
+    EXPECT_NEAR(expected[0], filter.process(signal[0]), EPSILON);
+}
@@ -0,0 +1,797 @@
+#ifndef __STATIC_DESIGN__H__
+#define __STATIC_DESIGN__H__
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include "filter_design.h"
+
+/** Butterworth design on fixed capacity storage, at compile time or without heap allocation at run time.
+ *
+ * Follows the same steps as filter_design::butter (analog prototype, frequency transformation, bilinear
+ * transform, zpk2sos pairing), but on fixed capacity arrays and with its own constexpr complex arithmetic,
+ * so it works in constant expressions (C++17) and never allocates. The coefficients agree with
+ * filter_design::butter up to rounding. Only where two poles are equally close to the unit circle (e.g. band
+ * filters centered at fs/4) rounding can decide which one is paired first, the cascade is the same filter.
+ */
+namespace static_design
+{
+    constexpr double PI = 3.141592653589793238463;
+
+    /** Complex number with constexpr arithmetic (std::complex is not constexpr in C++17). */
+    struct complex
+    {
+        double re = 0;
+        double im = 0;
+
+        constexpr complex() = default;
+        constexpr complex(double real, double imag = 0) : re(real), im(imag) {}
+
+        constexpr complex operator+(const complex &o) const { return complex(re + o.re, im + o.im); }
+        constexpr complex operator-(const complex &o) const { return complex(re - o.re, im - o.im); }
+        constexpr complex operator-() const { return complex(-re, -im); }
+        constexpr complex operator*(const complex &o) const { return complex(re * o.re - im * o.im, re * o.im + im * o.re); }
+        constexpr complex operator/(const complex &o) const
+        {
+            double d = o.re * o.re + o.im * o.im;
+            return complex((re * o.re + im * o.im) / d, (im * o.re - re * o.im) / d);
+        }
+    };
+
+    constexpr complex conj(const complex &z) { return complex(z.re, -z.im); }
+
+    /** Square root (Newton iteration, exact to the last bit or one below).
+     *
+     * @param x non-negative number
+     * @return square root of x
+     */
+    constexpr double sqrt(double x)
+    {
+        if (!(x > 0))
+        {
+            return 0;
+        }
+        // start above the root, the iteration then decreases monotonically
+        double r = x > 1 ? x : 1;
+        for (;;)
+        {
+            double next = 0.5 * (r + x / r);
+            if (!(next < r))
+            {
+                return r;
+            }
+            r = next;
+        }
+    }
+
+    constexpr double abs(double x) { return x < 0 ? -x : x; }
+
+    constexpr double abs(const complex &z) { return sqrt(z.re * z.re + z.im * z.im); }
+
+    /** Principal square root of a complex number.
+     *
+     * @param z complex number
+     * @return square root with non-negative real part
+     */
+    constexpr complex sqrt(const complex &z)
+    {
+        double m = abs(z);
+        double re = sqrt((m + z.re) / 2);
+        double im = sqrt((m - z.re) / 2);
+        return complex(re, z.im < 0 ? -im : im);
+    }
+
+    /** Sine (range reduction to [-pi/2, pi/2] and Taylor series).
+     *
+     * @param x angle in radian
+     * @return sine of x
+     */
+    constexpr double sin(double x)
+    {
+        // reduce to [-pi, pi], then mirror to [-pi/2, pi/2]
+        double k = x / (2 * PI);
+        long long n = static_cast<long long>(k < 0 ? k - 0.5 : k + 0.5);
+        x -= static_cast<double>(n) * 2 * PI;
+        if (x > PI / 2)
+        {
+            x = PI - x;
+        }
+        else if (x < -PI / 2)
+        {
+            x = -PI - x;
+        }
+
+        double term = x;
+        double sum = x;
+        for (int i = 1; i < 30; i++)
+        {
+            term *= -x * x / ((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    /** Cosine (see sin).
+     *
+     * @param x angle in radian
+     * @return cosine of x
+     */
+    constexpr double cos(double x)
+    {
+        double k = x / (2 * PI);
+        long long n = static_cast<long long>(k < 0 ? k - 0.5 : k + 0.5);
+        x = abs(x - static_cast<double>(n) * 2 * PI);
+        double sign = 1;
+        if (x > PI / 2)
+        {
+            x = PI - x;
+            sign = -1;
+        }
+
+        double term = 1;
+        double sum = 1;
+        for (int i = 1; i < 30; i++)
+        {
+            term *= -x * x / ((2 * i - 1) * (2 * i));
+            sum += term;
+        }
+        return sign * sum;
+    }
+
+    constexpr double tan(double x) { return sin(x) / cos(x); }
+
+    constexpr bool is_real(const complex &z) { return abs(z.im) < 100 * std::numeric_limits<double>::epsilon(); }
+
+    /** Number of second order sections of a Butterworth filter.
+     *
+     * @param filter_order order of the filter
+     * @param type type of the filter
+     * @return number of sections
+     */
+    constexpr std::size_t n_sections(int filter_order, filter_design::filter_type type)
+    {
+        bool band = type == filter_design::filter_type::bandpass || type == filter_design::filter_type::bandstop;
+        return band ? static_cast<std::size_t>(filter_order) : static_cast<std::size_t>(filter_order + 1) / 2;
+    }
+
+    /** Fixed capacity list of complex numbers (zeros or poles). */
+    template <std::size_t N>
+    struct roots
+    {
+        std::array<complex, N> values{};
+        std::size_t size = 0;
+
+        constexpr void push_back(const complex &z)
+        {
+            if (size == N)
+            {
+                throw std::length_error("Capacity of the design is too small");
+            }
+            values[size++] = z;
+        }
+
+        constexpr complex pop(std::size_t index)
+        {
+            complex z = values[index];
+            for (std::size_t i = index + 1; i < size; i++)
+            {
+                values[i - 1] = values[i];
+            }
+            size--;
+            return z;
+        }
+
+        /** Stable insertion sort (std::sort on the few roots of a design behaves the same). */
+        template <typename Less>
+        constexpr void sort(Less less)
+        {
+            for (std::size_t i = 1; i < size; i++)
+            {
+                complex z = values[i];
+                std::size_t j = i;
+                for (; j > 0 && less(z, values[j - 1]); j--)
+                {
+                    values[j] = values[j - 1];
+                }
+                values[j] = z;
+            }
+        }
+
+        constexpr std::size_t count_real() const
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < size; i++)
+            {
+                count += is_real(values[i]) ? 1 : 0;
+            }
+            return count;
+        }
+    };
+
+    /** Zeros, poles and gain with capacity for N zeros and N poles. */
+    template <std::size_t N>
+    struct zpk
+    {
+        roots<N> zeros;
+        roots<N> poles;
+        double gain = 1;
+
+        constexpr int degree() const { return static_cast<int>(poles.size) - static_cast<int>(zeros.size); }
+    };
+
+    /** See filter_design::analog_lowpass. */
+    template <std::size_t N>
+    constexpr zpk<N> analog_lowpass(int filter_order)
+    {
+        zpk<N> result;
+        for (int m = -filter_order + 1; m < filter_order; m += 2)
+        {
+            double theta = PI * m / (2.0 * filter_order);
+            result.poles.push_back(complex(-cos(theta), -sin(theta)));
+        }
+        return result;
+    }
+
+    /** See filter_design::lp2lp. */
+    template <std::size_t N>
+    constexpr zpk<N> lp2lp(const zpk<N> &in, double cutoff_frequency)
+    {
+        zpk<N> result;
+        for (std::size_t i = 0; i < in.zeros.size; i++)
+        {
+            result.zeros.push_back(in.zeros.values[i] * cutoff_frequency);
+        }
+        for (std::size_t i = 0; i < in.poles.size; i++)
+        {
+            result.poles.push_back(in.poles.values[i] * cutoff_frequency);
+        }
+        result.gain = in.gain;
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.gain *= cutoff_frequency;
+        }
+        return result;
+    }
+
+    /** Gain change of inverting the roots: real(prod(-z) / prod(-p)). */
+    template <std::size_t N>
+    constexpr double inversion_gain(const zpk<N> &in)
+    {
+        complex prod_z(1);
+        for (std::size_t i = 0; i < in.zeros.size; i++)
+        {
+            prod_z = prod_z * -in.zeros.values[i];
+        }
+        complex prod_p(1);
+        for (std::size_t i = 0; i < in.poles.size; i++)
+        {
+            prod_p = prod_p * -in.poles.values[i];
+        }
+        return (prod_z / prod_p).re;
+    }
+
+    /** See filter_design::lp2hp. */
+    template <std::size_t N>
+    constexpr zpk<N> lp2hp(const zpk<N> &in, double cutoff_frequency)
+    {
+        zpk<N> result;
+        for (std::size_t i = 0; i < in.zeros.size; i++)
+        {
+            result.zeros.push_back(complex(cutoff_frequency) / in.zeros.values[i]);
+        }
+        for (std::size_t i = 0; i < in.poles.size; i++)
+        {
+            result.poles.push_back(complex(cutoff_frequency) / in.poles.values[i]);
+        }
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.zeros.push_back(complex(0));
+        }
+        result.gain = in.gain * inversion_gain(in);
+        return result;
+    }
+
+    /** Duplicate the roots and shift them from baseband to +center and -center (order as in scipy). */
+    template <std::size_t N>
+    constexpr void shift_roots(const roots<N> &in, roots<N> &out, double center, double half_width, bool invert)
+    {
+        for (double sign : {1.0, -1.0})
+        {
+            for (std::size_t i = 0; i < in.size; i++)
+            {
+                complex z = invert ? complex(half_width) / in.values[i] : in.values[i] * half_width;
+                complex root = sqrt(z * z - complex(center * center));
+                out.push_back(sign > 0 ? z + root : z - root);
+            }
+        }
+    }
+
+    /** See filter_design::lp2bp. */
+    template <std::size_t N>
+    constexpr zpk<N> lp2bp(const zpk<N> &in, double passband_center, double passband_width)
+    {
+        zpk<N> result;
+        shift_roots(in.zeros, result.zeros, passband_center, passband_width / 2, false);
+        shift_roots(in.poles, result.poles, passband_center, passband_width / 2, false);
+        result.gain = in.gain;
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.zeros.push_back(complex(0));
+            result.gain *= passband_width;
+        }
+        return result;
+    }
+
+    /** See filter_design::lp2bs. */
+    template <std::size_t N>
+    constexpr zpk<N> lp2bs(const zpk<N> &in, double stopband_center, double stopband_width)
+    {
+        zpk<N> result;
+        shift_roots(in.zeros, result.zeros, stopband_center, stopband_width / 2, true);
+        shift_roots(in.poles, result.poles, stopband_center, stopband_width / 2, true);
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.zeros.push_back(complex(0, stopband_center));
+        }
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.zeros.push_back(complex(0, -stopband_center));
+        }
+        result.gain = in.gain * inversion_gain(in);
+        return result;
+    }
+
+    /** See filter_design::bilinear_transform. */
+    template <std::size_t N>
+    constexpr zpk<N> bilinear_transform(const zpk<N> &in, double sampling_frequency)
+    {
+        const complex fs2(2.0 * sampling_frequency);
+        zpk<N> result;
+        complex prod_z(1);
+        for (std::size_t i = 0; i < in.zeros.size; i++)
+        {
+            result.zeros.push_back((fs2 + in.zeros.values[i]) / (fs2 - in.zeros.values[i]));
+            prod_z = prod_z * (fs2 - in.zeros.values[i]);
+        }
+        complex prod_p(1);
+        for (std::size_t i = 0; i < in.poles.size; i++)
+        {
+            result.poles.push_back((fs2 + in.poles.values[i]) / (fs2 - in.poles.values[i]));
+            prod_p = prod_p * (fs2 - in.poles.values[i]);
+        }
+        // zeros at infinity move to the Nyquist frequency
+        for (int i = 0; i < in.degree(); i++)
+        {
+            result.zeros.push_back(complex(-1));
+        }
+        result.gain = in.gain * (prod_z / prod_p).re;
+        return result;
+    }
+
+    /** See filter_design::cplxpair: real roots (sorted) followed by the roots with positive imaginary part. */
+    template <std::size_t N>
+    constexpr roots<N> cplxpair(roots<N> z)
+    {
+        z.sort([](const complex &a, const complex &b)
+               { return a.re == b.re ? a.im < b.im : a.re < b.re; });
+        roots<N> real;
+        roots<N> positive;
+        std::size_t n_negative = 0;
+        for (std::size_t i = 0; i < z.size; i++)
+        {
+            if (is_real(z.values[i]))
+            {
+                real.push_back(complex(z.values[i].re));
+            }
+            else if (z.values[i].im > 0)
+            {
+                positive.push_back(z.values[i]);
+            }
+            else
+            {
+                n_negative++;
+            }
+        }
+        if (positive.size != n_negative)
+        {
+            throw std::invalid_argument("Array contains complex value with no matching conjugate");
+        }
+        for (std::size_t i = 0; i < positive.size; i++)
+        {
+            real.push_back(positive.values[i]);
+        }
+        return real;
+    }
+
+    /** Remove the root nearest to `to` that is real (or complex), the first one on ties (see filter_design::zpk2sos). */
+    template <std::size_t N>
+    constexpr complex pop_nearest_real_complex(roots<N> &from, const complex &to, bool real)
+    {
+        std::size_t nearest = from.size;
+        for (std::size_t i = 0; i < from.size; i++)
+        {
+            if (is_real(from.values[i]) == real && (nearest == from.size || abs(from.values[i] - to) < abs(from.values[nearest] - to)))
+            {
+                nearest = i;
+            }
+        }
+        if (nearest == from.size)
+        {
+            throw std::logic_error("Cannot find real/complex number in array.");
+        }
+        return from.pop(nearest);
+    }
+
+    /** See filter_design::zpk2sos.
+     *
+     * @param in zeros, poles and gain (as many zeros as poles)
+     * @param sos output for the coefficients (b0, b1, b2, a1, a2), room for (N + 1) / 2 sections
+     * @return number of sections
+     */
+    template <std::size_t N>
+    constexpr std::size_t zpk2sos(zpk<N> in, std::array<double, 5> *sos)
+    {
+        if (in.zeros.size != in.poles.size)
+        {
+            throw std::invalid_argument("Number of poles and zeros does not match");
+        }
+        if (in.zeros.size % 2 == 1)
+        {
+            in.poles.push_back(complex(0));
+            in.zeros.push_back(complex(0));
+        }
+        const std::size_t S = in.poles.size / 2;
+
+        roots<N> poles(cplxpair(in.poles));
+        roots<N> zeros(cplxpair(in.zeros));
+
+        // sort poles by how close they are to the unit circle
+        poles.sort([](const complex &p1, const complex &p2)
+                   { return abs(1.0 - abs(p1)) < abs(1.0 - abs(p2)); });
+
+        std::array<std::array<complex, 4>, N / 2> pairs{}; // p1, p2, z1, z2
+        for (std::size_t s = 0; s < S; s++)
+        {
+            complex p1 = poles.pop(0);
+            complex p2, z1, z2;
+            std::size_t n_real = poles.count_real();
+            if (is_real(p1) && n_real == 0)
+            {
+                // first order section
+                z1 = pop_nearest_real_complex(zeros, p1, true);
+            }
+            else
+            {
+                if (!is_real(p1) && n_real == 1)
+                {
+                    z1 = pop_nearest_real_complex(zeros, p1, false);
+                }
+                else
+                {
+                    // the closest zero (first one on ties)
+                    std::size_t nearest = 0;
+                    for (std::size_t i = 1; i < zeros.size; i++)
+                    {
+                        if (abs(p1 - zeros.values[i]) < abs(p1 - zeros.values[nearest]))
+                        {
+                            nearest = i;
+                        }
+                    }
+                    z1 = zeros.pop(nearest);
+                }
+
+                if (!is_real(p1))
+                {
+                    p2 = conj(p1);
+                    z2 = is_real(z1) ? pop_nearest_real_complex(zeros, p1, true) : conj(z1);
+                }
+                else if (!is_real(z1))
+                {
+                    z2 = conj(z1);
+                    p2 = pop_nearest_real_complex(poles, z1, true);
+                }
+                else
+                {
+                    // the next "worst" real pole and the real zero closest to it
+                    std::size_t next = 0;
+                    while (!is_real(poles.values[next]))
+                    {
+                        next++;
+                    }
+                    p2 = poles.pop(next);
+                    z2 = pop_nearest_real_complex(zeros, p2, true);
+                }
+            }
+            pairs[s] = {p1, p2, z1, z2};
+        }
+
+        // reverse the order, so the "worst" sections are last, the gain goes to the first section
+        for (std::size_t i = 0; i < S; i++)
+        {
+            const std::array<complex, 4> &pair = pairs[S - 1 - i];
+            double gain = i == 0 ? in.gain : 1;
+            sos[i] = {gain,
+                      gain * (-pair[2] - pair[3]).re,
+                      gain * (pair[2] * pair[3]).re,
+                      (-pair[0] - pair[1]).re,
+                      (pair[0] * pair[1]).re};
+        }
+        return S;
+    }
+
+    /** Digital zeros, poles and gain of a Butterworth filter (all steps of filter_design::butter but the pairing).
+     *
+     * @tparam N capacity of the zeros and poles (at least 2 * filter_order + 2)
+     * @param filter_order order of the filter
+     * @param freq critical frequencies (one for lowpass and highpass, two for bandpass and bandstop)
+     * @param type type of the filter
+     * @param sampling_frequency sampling frequency of the digital system
+     * @return zeros, poles and gain
+     */
+    template <std::size_t N>
+    constexpr zpk<N> butter_zpk(int filter_order, const double *freq, filter_design::filter_type type, double sampling_frequency)
+    {
+        const bool band = type == filter_design::filter_type::bandpass || type == filter_design::filter_type::bandstop;
+        const std::size_t M = band ? 2 : 1;
+        double warped[2]{};
+        for (std::size_t i = 0; i < M; i++)
+        {
+            double wn = 2 * freq[i] / sampling_frequency;
+            if (wn <= 0 || wn >= 1)
+            {
+                throw std::invalid_argument("Digital filter critical frequencies in freq must be 0 < f < fs/2");
+            }
+            // pre-warp for the bilinear transform with fs = 2
+            warped[i] = 4 * tan(PI * wn / 2);
+        }
+
+        zpk<N> design(analog_lowpass<N>(filter_order));
+        switch (type)
+        {
+        case filter_design::filter_type::lowpass:
+            design = lp2lp(design, warped[0]);
+            break;
+        case filter_design::filter_type::highpass:
+            design = lp2hp(design, warped[0]);
+            break;
+        case filter_design::filter_type::bandpass:
+            design = lp2bp(design, sqrt(warped[0] * warped[1]), abs(warped[1] - warped[0]));
+            break;
+        case filter_design::filter_type::bandstop:
+            design = lp2bs(design, sqrt(warped[0] * warped[1]), abs(warped[1] - warped[0]));
+            break;
+        }
+        return bilinear_transform(design, 2.0);
+    }
+
+    /** Butterworth digital filter design without heap allocation (see filter_design::butter).
+     *
+     * All intermediate zeros and poles live in fixed capacity arrays on the stack (a few kB for MaxOrder 16),
+     * so filters can be redesigned on real-time threads, e.g. to tune the cutoff frequency.
+     *
+     * @tparam MaxOrder capacity, highest supported filter order
+     * @param filter_order order of the filter, throws std::invalid_argument if not in [1, MaxOrder]
+     * @param freq critical frequencies (one for lowpass and highpass, two for bandpass and bandstop)
+     * @param type type of the filter
+     * @param sampling_frequency sampling frequency of the digital system
+     * @param sections output for the coefficients (b0, b1, b2, a1, a2), room for n_sections(filter_order, type)
+     * @return number of sections
+     */
+    template <int MaxOrder>
+    constexpr std::size_t butter(int filter_order, const double *freq, filter_design::filter_type type,
+                                 double sampling_frequency, std::array<double, 5> *sections)
+    {
+        static_assert(MaxOrder > 0, "MaxOrder must be positive");
+        // capacity for the roots of the band filters and the padding of odd orders
+        constexpr std::size_t N = 2 * static_cast<std::size_t>(MaxOrder) + 2;
+        if (filter_order < 1 || filter_order > MaxOrder)
+        {
+            throw std::invalid_argument("Filter order must be between 1 and the capacity of the design");
+        }
+        return zpk2sos(butter_zpk<N>(filter_order, freq, type, sampling_frequency), sections);
+    }
+
+    /** Index of the unused root nearest to r, marked as used.
+     *
+     * @return N if the nearest root is further than the tolerance away
+     */
+    template <std::size_t N>
+    constexpr std::size_t take_nearest(const roots<N> &from, std::array<bool, N> &used, const complex &r)
+    {
+        // a double root is only known to about sqrt(eps) from the coefficients
+        const double tolerance = 1.0e-6;
+        std::size_t nearest = N;
+        for (std::size_t i = 0; i < from.size; i++)
+        {
+            if (!used[i] && (nearest == N || abs(from.values[i] - r) < abs(from.values[nearest] - r)))
+            {
+                nearest = i;
+            }
+        }
+        if (nearest == N || abs(from.values[nearest] - r) > tolerance * (1 + abs(r)))
+        {
+            return N;
+        }
+        used[nearest] = true;
+        return nearest;
+    }
+
+    /** Indices of the roots of z^2 + c1 * z + c2 in a list of roots.
+     *
+     * @return false if they are not in the list
+     */
+    template <std::size_t N>
+    constexpr bool find_roots(double c1, double c2, const roots<N> &from, std::array<bool, N> &used, std::size_t &i1, std::size_t &i2)
+    {
+        complex root = sqrt(complex(c1 * c1 - 4 * c2));
+        i1 = take_nearest(from, used, (complex(-c1) + root) / 2.0);
+        i2 = take_nearest(from, used, (complex(-c1) - root) / 2.0);
+        return i1 != N && i2 != N;
+    }
+
+    /** Unpaired design of butter with the padding of zpk2sos (a zero and a pole at 0 for odd counts).
+     *
+     * The roots are in the same order for all critical frequencies of an order and type.
+     */
+    template <std::size_t N>
+    constexpr zpk<N> padded_zpk(int filter_order, const double *freq, filter_design::filter_type type, double sampling_frequency)
+    {
+        zpk<N> design(butter_zpk<N>(filter_order, freq, type, sampling_frequency));
+        if (design.zeros.size % 2 == 1)
+        {
+            design.poles.push_back(complex(0));
+            design.zeros.push_back(complex(0));
+        }
+        return design;
+    }
+
+    /** Check the arguments of pair_roots and retune.
+     *
+     * Throws std::invalid_argument if the order is not in [1, MaxOrder] or the number of sections does not
+     * fit the order and type.
+     */
+    template <int MaxOrder>
+    constexpr void check_retune(int filter_order, filter_design::filter_type type, std::size_t n_sections)
+    {
+        static_assert(MaxOrder > 0, "MaxOrder must be positive");
+        if (filter_order < 1 || filter_order > MaxOrder)
+        {
+            throw std::invalid_argument("Filter order must be between 1 and the capacity of the design");
+        }
+        if (n_sections != static_design::n_sections(filter_order, type))
+        {
+            throw std::invalid_argument("Number of sections does not match the filter order and type");
+        }
+    }
+
+    /** Find the poles and zeros of every section in the (unpaired) design for its critical frequencies.
+     *
+     * The indices are valid for every critical frequency of the same order, type and sampling frequency, so
+     * the pairing (O(n^2)) is done once and a filter is retuned in O(n) with them afterwards (see retune).
+     * No heap allocation.
+     *
+     * @tparam MaxOrder capacity, highest supported filter order
+     * @param filter_order order of the filter, throws std::invalid_argument if not in [1, MaxOrder]
+     * @param freq critical frequencies the sections were designed for
+     * @param type type of the filter
+     * @param sampling_frequency sampling frequency of the digital system
+     * @param sections coefficients (b0, b1, b2, a1, a2)
+     * @param n_sections number of sections, throws std::invalid_argument if it does not fit the order and type
+     * @param indices output, indices of the roots (p1, p2, z1, z2) of every section
+     * @return false if the sections do not belong to the design, a full design (butter) is required then
+     */
+    template <int MaxOrder>
+    constexpr bool pair_roots(int filter_order, const double *freq, filter_design::filter_type type, double sampling_frequency,
+                              const std::array<double, 5> *sections, std::size_t n_sections, std::array<std::size_t, 4> *indices)
+    {
+        constexpr std::size_t N = 2 * static_cast<std::size_t>(MaxOrder) + 2;
+        check_retune<MaxOrder>(filter_order, type, n_sections);
+
+        zpk<N> design(padded_zpk<N>(filter_order, freq, type, sampling_frequency));
+        std::array<bool, N> used_poles{};
+        std::array<bool, N> used_zeros{};
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            const std::array<double, 5> &c = sections[s];
+            std::array<std::size_t, 4> &index = indices[s];
+            if (c[0] == 0 ||
+                !find_roots(c[3], c[4], design.poles, used_poles, index[0], index[1]) ||
+                !find_roots(c[1] / c[0], c[2] / c[0], design.zeros, used_zeros, index[2], index[3]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Redesign second order sections for new critical frequencies with the pairing of pair_roots.
+     *
+     * For retuning a running filter (same order, type and sampling frequency): one unpaired design and an
+     * O(n) rebuild of the sections, no zpk2sos pairing. The roots at the indices of every section are taken
+     * from the design for the new frequencies, so every section keeps its place in the cascade and follows
+     * its roots continuously, the gain goes to the first section. For small changes this is the result of
+     * butter, for large jumps the order of the sections may differ from the one of butter (sorted by the
+     * distance of the poles to the unit circle). No heap allocation.
+     *
+     * @tparam MaxOrder capacity, highest supported filter order
+     * @param filter_order order of the filter, throws std::invalid_argument if not in [1, MaxOrder]
+     * @param freq new critical frequencies (one for lowpass and highpass, two for bandpass and bandstop)
+     * @param type type of the filter
+     * @param sampling_frequency sampling frequency of the digital system
+     * @param indices indices of the roots of every section (see pair_roots)
+     * @param sections output for the coefficients (b0, b1, b2, a1, a2)
+     * @param n_sections number of sections, throws std::invalid_argument if it does not fit the order and type
+     */
+    template <int MaxOrder>
+    constexpr void retune(int filter_order, const double *freq, filter_design::filter_type type, double sampling_frequency,
+                          const std::array<std::size_t, 4> *indices, std::array<double, 5> *sections, std::size_t n_sections)
+    {
+        constexpr std::size_t N = 2 * static_cast<std::size_t>(MaxOrder) + 2;
+        check_retune<MaxOrder>(filter_order, type, n_sections);
+
+        zpk<N> design(padded_zpk<N>(filter_order, freq, type, sampling_frequency));
+        for (std::size_t s = 0; s < n_sections; s++)
+        {
+            const std::array<std::size_t, 4> &index = indices[s];
+            const complex &p1 = design.poles.values[index[0]];
+            const complex &p2 = design.poles.values[index[1]];
+            const complex &z1 = design.zeros.values[index[2]];
+            const complex &z2 = design.zeros.values[index[3]];
+            double gain = s == 0 ? design.gain : 1;
+            sections[s] = {gain, gain * (-z1 - z2).re, gain * (z1 * z2).re, (-p1 - p2).re, (p1 * p2).re};
+        }
+    }
+
+    /** Redesign second order sections for new critical frequencies, keeping the place of every section.
+     *
+     * pair_roots for the current frequencies followed by retune, so a single call costs two designs and the
+     * O(n^2) pairing, more than butter. To retune repeatedly, keep the indices of pair_roots and call retune.
+     *
+     * @tparam MaxOrder capacity, highest supported filter order
+     * @param filter_order order of the filter, throws std::invalid_argument if not in [1, MaxOrder]
+     * @param current_freq current critical frequencies (one for lowpass and highpass, two for bandpass and bandstop)
+     * @param freq new critical frequencies
+     * @param type type of the filter
+     * @param sampling_frequency sampling frequency of the digital system
+     * @param sections coefficients (b0, b1, b2, a1, a2) designed for current_freq, replaced by the new ones
+     * @param n_sections number of sections, throws std::invalid_argument if it does not fit the order and type
+     * @return false if the sections do not belong to the current design, they are unchanged then and a full
+     *         design (butter) is required
+     */
+    template <int MaxOrder>
+    constexpr bool retune(int filter_order, const double *current_freq, const double *freq, filter_design::filter_type type,
+                          double sampling_frequency, std::array<double, 5> *sections, std::size_t n_sections)
+    {
+        check_retune<MaxOrder>(filter_order, type, n_sections);
+        std::array<std::array<std::size_t, 4>, static_cast<std::size_t>(MaxOrder) + 1> indices{};
+        if (!pair_roots<MaxOrder>(filter_order, current_freq, type, sampling_frequency, sections, n_sections, indices.data()))
+        {
+            return false;
+        }
+        retune<MaxOrder>(filter_order, freq, type, sampling_frequency, indices.data(), sections, n_sections);
+        return true;
+    }
+
+    /** Butterworth digital filter design at compile time (see filter_design::butter).
+     *
+     * @tparam Order order of the filter
+     * @tparam Type type of the filter
+     * @param freq critical frequencies (one for lowpass and highpass, two for bandpass and bandstop)
+     * @param sampling_frequency sampling frequency of the digital system
+     * @return coefficients (b0, b1, b2, a1, a2) of the second order sections
+     */
+    template <int Order, filter_design::filter_type Type, std::size_t M>
+    constexpr std::array<std::array<double, 5>, n_sections(Order, Type)> butter(const double (&freq)[M], double sampling_frequency)
+    {
+        static_assert(Order > 0, "Order must be positive");
+        constexpr bool band = Type == filter_design::filter_type::bandpass || Type == filter_design::filter_type::bandstop;
+        static_assert(M == (band ? 2 : 1), "Lowpass and highpass filters take one, bandpass and bandstop filters two critical frequencies");
+
+        std::array<std::array<double, 5>, n_sections(Order, Type)> sections{};
+        butter<Order>(Order, freq, Type, sampling_frequency, sections.data());
+        return sections;
+    }
+} // namespace static_design
+
+#endif //!__STATIC_DESIGN__H__
@@ -0,0 +1,161 @@
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "filter_design.h"
+#include "static_design.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // constant expressions cannot allocate, so evaluating the design and the retune at compile time shows
+    // that they do not use the heap
+    constexpr double design_and_retune(filter_design::filter_type type)
+    {
+        std::array<std::array<double, 5>, 4> sections{};
+        std::array<std::array<std::size_t, 4>, 4> indices{};
+        double current[] = {1000, 2000};
+        double freq[] = {1200, 2400};
+        double next[] = {1500, 3000};
+        std::size_t n = static_design::butter<4>(4, current, type, 44100, sections.data());
+        if (!static_design::pair_roots<4>(4, current, type, 44100, sections.data(), n, indices.data()))
+        {
+            return 0;
+        }
+        static_design::retune<4>(4, freq, type, 44100, indices.data(), sections.data(), n);
+        if (!static_design::retune<4>(4, freq, next, type, 44100, sections.data(), n))
+        {
+            return 0;
+        }
+        return sections[0][0];
+    }
+
+    static_assert(design_and_retune(filter_design::filter_type::lowpass) > 0, "designed and retuned at compile time");
+    static_assert(design_and_retune(filter_design::filter_type::bandpass) > 0, "designed and retuned at compile time");
+} // namespace
+
+TEST(static_design_test, butter)
+{
+    const double EPSILON = 1.0e-12;
+
+    std::array<std::array<double, 5>, 16> sections{};
+    struct
+    {
+        int filter_order;
+        std::vector<double> freq;
+        filter_design::filter_type type;
+        double sampling_frequency;
+    } designs[] = {{1, {15}, filter_design::filter_type::lowpass, 50},
+                   {16, {100}, filter_design::filter_type::lowpass, 44100},
+                   {5, {0.5}, filter_design::filter_type::highpass, 48},
+                   {8, {45, 55}, filter_design::filter_type::bandpass, 1000},
+                   {5, {45, 55}, filter_design::filter_type::bandstop, 1000},
+                   {5, {0.3, 4.0}, filter_design::filter_type::bandstop, 50}};
+
+    for (const auto &design : designs)
+    {
+        std::vector<biquad> expected(filter_design::butter(design.filter_order, design.freq, design.type, design.sampling_frequency));
+        std::size_t n = static_design::butter<16>(design.filter_order, design.freq.data(), design.type,
+                                                  design.sampling_frequency, sections.data());
+
+        ASSERT_EQ(expected.size(), n);
+        EXPECT_EQ(static_design::n_sections(design.filter_order, design.type), n);
+        for (std::size_t s = 0; s < n; s++)
+        {
+            std::vector<double> coefficients(expected[s].get_coefficients());
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                EXPECT_NEAR(coefficients[i], sections[s][i], EPSILON * std::max(1.0, std::abs(coefficients[i])));
+            }
+        }
+    }
+
+    // order out of the capacity and invalid frequencies
+    double freq[] = {10, 20};
+    EXPECT_THROW(static_design::butter<4>(5, freq, filter_design::filter_type::lowpass, 50, sections.data()), std::invalid_argument);
+    EXPECT_THROW(static_design::butter<4>(0, freq, filter_design::filter_type::lowpass, 50, sections.data()), std::invalid_argument);
+    EXPECT_THROW(static_design::butter<4>(4, freq, filter_design::filter_type::bandpass, 30, sections.data()), std::invalid_argument);
+}
+
+TEST(static_design_test, retune)
+{
+    const double EPSILON = 1.0e-10;
+
+    // sweep in steps, the sections of the lowpass and highpass keep the order of butter
+    for (filter_design::filter_type type : {filter_design::filter_type::lowpass, filter_design::filter_type::highpass})
+    {
+        std::array<std::array<double, 5>, 8> sections{};
+        double current[] = {100};
+        std::size_t n = static_design::butter<16>(15, current, type, 44100, sections.data());
+        EXPECT_EQ(8u, n);
+
+        for (double f = 150; f < 10000; f *= 1.5)
+        {
+            double freq[] = {f};
+            EXPECT_TRUE(static_design::retune<16>(15, current, freq, type, 44100, sections.data(), n));
+            current[0] = f;
+        }
+
+        // same poles, the zeros of the first order section may be paired differently (butter moves the
+        // padding zero when the real pole gets closer to it), so compare the impulse responses
+        std::vector<biquad> expected(filter_design::butter(15, {current[0]}, type, 44100));
+        std::vector<biquad> result;
+        for (std::size_t s = 0; s < n; s++)
+        {
+            std::vector<double> coefficients(expected[s].get_coefficients());
+            EXPECT_NEAR(coefficients[3], sections[s][3], EPSILON);
+            EXPECT_NEAR(coefficients[4], sections[s][4], EPSILON);
+            result.emplace_back(sections[s][0], sections[s][1], sections[s][2], sections[s][3], sections[s][4]);
+        }
+        std::vector<double> impulse(200, 0.0);
+        impulse[0] = 1;
+        std::vector<double> expected_response(impulse.size());
+        std::vector<double> response(impulse.size());
+        biquad::process_cascade(expected.data(), expected.size(), impulse.data(), expected_response.data(), impulse.size());
+        biquad::process_cascade(result.data(), result.size(), impulse.data(), response.data(), impulse.size());
+        for (std::size_t i = 0; i < impulse.size(); i++)
+        {
+            EXPECT_NEAR(expected_response[i], response[i], EPSILON);
+        }
+    }
+
+    // the pairing of the first design holds for the whole sweep
+    {
+        std::array<std::array<double, 5>, 6> paired{};
+        std::array<std::array<double, 5>, 6> repaired{};
+        std::array<std::array<std::size_t, 4>, 6> indices{};
+        double current[] = {1000, 2000};
+        filter_design::filter_type type = filter_design::filter_type::bandpass;
+        std::size_t n = static_design::butter<8>(6, current, type, 44100, paired.data());
+        repaired = paired;
+        EXPECT_TRUE(static_design::pair_roots<8>(6, current, type, 44100, paired.data(), n, indices.data()));
+
+        for (double f = 1100; f < 5000; f *= 1.2)
+        {
+            double freq[] = {f, 2 * f};
+            static_design::retune<8>(6, freq, type, 44100, indices.data(), paired.data(), n);
+            EXPECT_TRUE(static_design::retune<8>(6, current, freq, type, 44100, repaired.data(), n));
+            current[0] = freq[0];
+            current[1] = freq[1];
+        }
+        for (std::size_t s = 0; s < n; s++)
+        {
+            for (std::size_t i = 0; i < 5; i++)
+            {
+                EXPECT_NEAR(repaired[s][i], paired[s][i], EPSILON);
+            }
+        }
+    }
+
+    // sections of another design cannot be retuned
+    std::array<std::array<double, 5>, 4> sections{};
+    double current[] = {10};
+    double other[] = {12};
+    static_design::butter<8>(4, current, filter_design::filter_type::lowpass, 50, sections.data());
+    std::array<std::array<double, 5>, 4> unchanged(sections);
+    EXPECT_FALSE(static_design::retune<8>(4, other, current, filter_design::filter_type::lowpass, 50, sections.data(), 2));
+    EXPECT_EQ(unchanged, sections);
+    EXPECT_THROW(static_design::retune<8>(4, current, other, filter_design::filter_type::lowpass, 50, sections.data(), 3), std::invalid_argument);
+}
@@ -0,0 +1,183 @@
+#include "stream_executor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+template <typename T>
+basic_stream_executor<T>::basic_stream_executor(std::size_t n_threads)
+    : m_n_threads(n_threads != 0 ? n_threads : std::max(1u, std::thread::hardware_concurrency())),
+      m_queues(new worker_queue[m_n_threads])
+{
+    for (std::size_t i = 0; i < m_n_threads; i++)
+    {
+        m_workers.emplace_back(&basic_stream_executor::work, this, i);
+    }
+}
+
+template <typename T>
+basic_stream_executor<T>::~basic_stream_executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_ready.notify_all();
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+template <typename T>
+std::size_t basic_stream_executor<T>::add_stream(const basic_butterworth<T> &filter)
+{
+    m_streams.push_back(std::make_unique<stream>(filter));
+    return m_streams.size() - 1;
+}
+
+template <typename T>
+basic_butterworth<T> &basic_stream_executor<T>::get_filter(std::size_t stream)
+{
+    return m_streams.at(stream)->filter;
+}
+
+template <typename T>
+void basic_stream_executor<T>::enqueue(std::size_t worker, stream *task)
+{
+    {
+        // counted under the queue mutex like the decrement in take, so the counter never drops below 0
+        std::lock_guard<std::mutex> lock(m_queues[worker].mutex);
+        m_queued_tasks++;
+        m_queues[worker].tasks.push_back(task);
+    }
+    {
+        // pairs with the predicate check of a worker going to sleep
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_work_ready.notify_one();
+}
+
+template <typename T>
+typename basic_stream_executor<T>::stream *basic_stream_executor<T>::take(std::size_t worker)
+{
+    // own queue first (front, in order of scheduling)
+    {
+        std::lock_guard<std::mutex> lock(m_queues[worker].mutex);
+        std::deque<stream *> &tasks = m_queues[worker].tasks;
+        if (!tasks.empty())
+        {
+            stream *task = tasks.front();
+            tasks.pop_front();
+            m_queued_tasks--;
+            return task;
+        }
+    }
+
+    // steal from the back of the other queues
+    for (std::size_t k = 1; k < m_n_threads; k++)
+    {
+        worker_queue &victim = m_queues[(worker + k) % m_n_threads];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            stream *task = victim.tasks.back();
+            victim.tasks.pop_back();
+            m_queued_tasks--;
+            m_steals++;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+void basic_stream_executor<T>::run(std::size_t worker, stream *task)
+{
+    for (std::size_t turn = 0; turn < MAX_BLOCKS_PER_TURN; turn++)
+    {
+        block next;
+        {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            if (task->blocks.empty())
+            {
+                task->scheduled = false;
+                return;
+            }
+            next = task->blocks.front();
+            task->blocks.pop_front();
+        }
+
+        task->filter.process(next.in, next.out, next.n);
+
+        if (--m_pending_blocks == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_all_done.notify_all();
+        }
+    }
+
+    // turn is over, queue the stream again behind the other streams of this worker
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        if (task->blocks.empty())
+        {
+            task->scheduled = false;
+            return;
+        }
+    }
+    enqueue(worker, task);
+}
+
+template <typename T>
+void basic_stream_executor<T>::work(std::size_t worker)
+{
+    for (;;)
+    {
+        stream *task = take(worker);
+        if (task != nullptr)
+        {
+            run(worker, task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_work_ready.wait(lock, [this]
+                          { return m_stop || m_queued_tasks > 0; });
+        if (m_stop)
+        {
+            return;
+        }
+    }
+}
+
+template <typename T>
+void basic_stream_executor<T>::submit(std::size_t stream_index, const T *in, T *out, std::size_t n)
+{
+    stream *task = m_streams.at(stream_index).get();
+    m_pending_blocks++;
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->blocks.push_back(block{in, out, n});
+        if (!task->scheduled)
+        {
+            task->scheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule)
+    {
+        enqueue(stream_index % m_n_threads, task);
+    }
+}
+
+template <typename T>
+void basic_stream_executor<T>::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_all_done.wait(lock, [this]
+                    { return m_pending_blocks == 0; });
+}
+
+template class basic_stream_executor<double>;
+template class basic_stream_executor<float>;
@@ -0,0 +1,140 @@
+#ifndef __STREAM_EXECUTOR__H__
+#define __STREAM_EXECUTOR__H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "butterworth.h"
+
+/** Processes blocks of many independent filter streams (e.g. one per device) on a work-stealing thread pool.
+ *
+ * @tparam T sample type (explicitly instantiated for float and double)
+ *
+ * Every stream owns its filter and a queue of submitted blocks. A stream with pending blocks is scheduled as
+ * one task on the queue of a worker (stream index modulo number of workers, so a stream tends to stay on the
+ * same core). A worker takes tasks from the front of its own queue and, when it runs dry, steals from the
+ * back of the queues of the other workers, so bursts on some streams spread over all cores.
+ *
+ * Blocks of a stream are processed in the order they were submitted and never by two workers at the same
+ * time. A task processes at most MAX_BLOCKS_PER_TURN blocks and is then queued again behind the other
+ * streams of the worker, so a bursting stream does not stall its neighbours.
+ */
+template <typename T>
+class basic_stream_executor
+{
+private:
+    struct block
+    {
+        const T *in;
+        T *out;
+        std::size_t n;
+    };
+
+    struct stream
+    {
+        basic_butterworth<T> filter;
+        std::mutex mutex;         // guards blocks and scheduled
+        std::deque<block> blocks; // submitted, not yet processed
+        bool scheduled = false;   // queued on a worker or being processed
+
+        explicit stream(const basic_butterworth<T> &f) : filter(f) {}
+    };
+
+    struct alignas(64) worker_queue
+    {
+        std::mutex mutex;
+        std::deque<stream *> tasks;
+    };
+
+    std::size_t m_n_threads;
+    std::vector<std::unique_ptr<stream>> m_streams;
+    std::unique_ptr<worker_queue[]> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex; // guards the sleeping and waiting below
+    std::condition_variable m_work_ready;
+    std::condition_variable m_all_done;
+    std::atomic<std::size_t> m_queued_tasks{0};
+    std::atomic<std::size_t> m_pending_blocks{0};
+    std::atomic<std::size_t> m_steals{0};
+    bool m_stop = false;
+
+    void enqueue(std::size_t worker, stream *task);
+    stream *take(std::size_t worker);
+    void run(std::size_t worker, stream *task);
+    void work(std::size_t worker);
+
+public:
+    // blocks of a stream processed before the stream yields the worker to the next stream
+    static constexpr std::size_t MAX_BLOCKS_PER_TURN = 8;
+
+    /** Start the worker threads.
+     *
+     * @param n_threads number of worker threads (0 selects the number of hardware threads)
+     */
+    explicit basic_stream_executor(std::size_t n_threads = 0);
+
+    /** Stop and join the worker threads (blocks not yet processed are dropped). */
+    ~basic_stream_executor();
+
+    basic_stream_executor(const basic_stream_executor &) = delete;
+    basic_stream_executor &operator=(const basic_stream_executor &) = delete;
+
+    /** Add a stream. Must not be called concurrently with submit.
+     *
+     * @param filter filter of the stream (copied, including its state)
+     * @return index of the stream
+     */
+    std::size_t add_stream(const basic_butterworth<T> &filter);
+
+    /** Get number of streams
+     *
+     * @return number of streams
+     */
+    std::size_t get_streams() const { return m_streams.size(); }
+
+    /** Get number of worker threads
+     *
+     * @return number of threads
+     */
+    std::size_t get_threads() const { return m_n_threads; }
+
+    /** Get number of tasks taken from the queue of another worker (since construction)
+     *
+     * @return number of steals
+     */
+    std::size_t get_steals() const { return m_steals; }
+
+    /** Queue a block of a stream for processing (any thread; blocks of one stream are processed in the order
+     * of the calls).
+     *
+     * The buffers must stay valid until the block is processed (see wait), `in` and `out` may be the same.
+     *
+     * @param stream index of the stream, throws std::out_of_range if invalid
+     * @param in input samples
+     * @param out output buffer (at least n samples)
+     * @param n number of samples
+     */
+    void submit(std::size_t stream, const T *in, T *out, std::size_t n);
+
+    /** Wait until all submitted blocks are processed. */
+    void wait();
+
+    /** Get the filter of a stream (e.g. to inspect or change its state), only while no block of the stream is
+     * pending.
+     *
+     * @param stream index of the stream, throws std::out_of_range if invalid
+     * @return filter
+     */
+    basic_butterworth<T> &get_filter(std::size_t stream);
+};
+
+// double precision samples
+using stream_executor = basic_stream_executor<double>;
+
+#endif //!__STREAM_EXECUTOR__H__
@@ -0,0 +1,110 @@
+#include <vector>
+#include <cmath>
+#include <thread>
+
+#include "butterworth.h"
+#include "stream_executor.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    // different filter for every stream
+    butterworth stream_filter(std::size_t stream)
+    {
+        return butterworth{static_cast<int>(stream % 6) + 1, std::vector<double>{1.0 + stream % 20}, filter_design::filter_type::lowpass, 50};
+    }
+
+    std::vector<double> stream_signal(std::size_t stream, std::size_t n_samples)
+    {
+        std::vector<double> signal;
+        for (std::size_t i = 0; i < n_samples; i++)
+        {
+            signal.push_back(std::sin(0.01 * (stream + 1) * i) + 0.5 * std::sin(1.3 * i + stream));
+        }
+        return signal;
+    }
+}
+
+TEST(stream_executor_test, process)
+{
+    const std::size_t n_streams = 300;
+    const std::size_t n_samples = 2000;
+
+    stream_executor executor(4);
+    EXPECT_EQ(4u, executor.get_threads());
+    std::vector<std::vector<double>> signals;
+    std::vector<std::vector<double>> results;
+    for (std::size_t s = 0; s < n_streams; s++)
+    {
+        EXPECT_EQ(s, executor.add_stream(stream_filter(s)));
+        signals.push_back(stream_signal(s, n_samples));
+        results.emplace_back(n_samples);
+    }
+    EXPECT_EQ(n_streams, executor.get_streams());
+
+    // bursty streams: every stream gets its blocks of different size in order, some many more than others,
+    // submitted from two threads (each thread owns half of the streams)
+    auto submit = [&](std::size_t first)
+    {
+        for (std::size_t s = first; s < n_streams; s += 2)
+        {
+            std::size_t block = (s % 7 == 0) ? 10 : 100 + s % 300;
+            for (std::size_t start = 0; start < n_samples; start += block)
+            {
+                executor.submit(s, signals[s].data() + start, results[s].data() + start, std::min(block, n_samples - start));
+            }
+        }
+    };
+    std::thread other(submit, 1);
+    submit(0);
+    other.join();
+    executor.wait();
+
+    for (std::size_t s = 0; s < n_streams; s++)
+    {
+        std::vector<double> expected(stream_filter(s).process(signals[s]));
+        ASSERT_EQ(expected, results[s]) << "stream " << s;
+    }
+
+    // the state continues with the next blocks (in place)
+    std::vector<double> more(stream_signal(0, 100));
+    std::vector<double> expected(more);
+    butterworth reference(stream_filter(0));
+    reference.process(signals[0]);
+    reference.process(expected.data(), expected.data(), expected.size());
+    executor.submit(0, more.data(), more.data(), more.size());
+    executor.wait();
+    EXPECT_EQ(expected, more);
+
+    executor.get_filter(0).reset();
+    EXPECT_THROW(executor.submit(n_streams, more.data(), more.data(), more.size()), std::out_of_range);
+}
+
+TEST(stream_executor_test, stealing)
+{
+    // all blocks go to the streams of worker 0, the other workers only get work by stealing
+    const std::size_t n_threads = 3;
+    stream_executor executor(n_threads);
+    std::vector<std::vector<double>> signals;
+    std::vector<std::vector<double>> results;
+    for (std::size_t s = 0; s < 60; s++)
+    {
+        executor.add_stream(stream_filter(s));
+        signals.push_back(stream_signal(s, 5000));
+        results.emplace_back(5000);
+    }
+    for (std::size_t s = 0; s < 60; s += n_threads)
+    {
+        for (std::size_t start = 0; start < 5000; start += 50)
+        {
+            executor.submit(s, signals[s].data() + start, results[s].data() + start, 50);
+        }
+    }
+    executor.wait();
+
+    for (std::size_t s = 0; s < 60; s += n_threads)
+    {
+        EXPECT_EQ(stream_filter(s).process(signals[s]), results[s]) << "stream " << s;
+    }
+}
@@ -0,0 +1,198 @@
+#include "stream_stage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+    // empty polls before an idle thread sleeps instead of yielding
+    constexpr int SPIN_POLLS = 64;
+    constexpr std::chrono::microseconds IDLE_SLEEP(50);
+
+    std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** Back off after an unsuccessful poll.
+     *
+     * @param polls number of unsuccessful polls so far (incremented)
+     */
+    void back_off(int &polls)
+    {
+        if (++polls < SPIN_POLLS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(IDLE_SLEEP);
+        }
+    }
+} // namespace
+
+template <typename T>
+basic_stream_stage<T>::basic_stream_stage(const basic_butterworth<T> &filter, std::size_t capacity, std::size_t batch_size)
+    : m_filter(filter),
+      m_batch_size(batch_size),
+      m_input(capacity),
+      m_output(capacity),
+      m_markers(1024)
+{
+    if (batch_size == 0)
+    {
+        throw std::invalid_argument("Batch size must be at least 1");
+    }
+    m_worker = std::thread(&basic_stream_stage::work, this);
+}
+
+template <typename T>
+basic_stream_stage<T>::~basic_stream_stage()
+{
+    m_stop.store(true, std::memory_order_release);
+    m_worker.join();
+}
+
+template <typename T>
+void basic_stream_stage<T>::work()
+{
+    std::vector<T> batch(m_batch_size);
+    std::uint64_t published = 0;
+    marker pending{0, 0};
+    bool has_pending = false;
+    int polls = 0;
+
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+        std::size_t n = m_input.pop(batch.data(), batch.size());
+        if (n == 0)
+        {
+            back_off(polls);
+            continue;
+        }
+        polls = 0;
+
+        m_filter.process(batch.data(), batch.data(), n);
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+
+        // publish in order, wait while the consumer is behind
+        int waits = 0;
+        for (std::size_t written = 0; written < n;)
+        {
+            written += m_output.push(batch.data() + written, n - written);
+            if (written < n)
+            {
+                m_worker_waits.fetch_add(1, std::memory_order_relaxed);
+                back_off(waits);
+                if (m_stop.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+            }
+        }
+        published += n;
+        m_samples_out.store(published, std::memory_order_release);
+
+        // latency of every push whose last sample is published now
+        std::int64_t time = now();
+        while (has_pending || m_markers.pop(pending))
+        {
+            has_pending = true;
+            if (pending.end > published)
+            {
+                break;
+            }
+            has_pending = false;
+            std::int64_t latency = time - pending.time;
+            m_latency_sum.fetch_add(latency, std::memory_order_relaxed);
+            m_latency_count.fetch_add(1, std::memory_order_relaxed);
+            if (latency > m_latency_max.load(std::memory_order_relaxed))
+            {
+                m_latency_max.store(latency, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+template <typename T>
+std::size_t basic_stream_stage<T>::try_push(const T *samples, std::size_t n)
+{
+    std::size_t accepted = m_input.push(samples, n);
+    if (accepted > 0)
+    {
+        std::uint64_t pushed = m_samples_in.load(std::memory_order_relaxed) + accepted;
+        m_samples_in.store(pushed, std::memory_order_relaxed);
+        m_markers.push(marker{pushed, now()});
+    }
+    if (accepted < n)
+    {
+        m_samples_rejected.fetch_add(n - accepted, std::memory_order_relaxed);
+    }
+    return accepted;
+}
+
+template <typename T>
+void basic_stream_stage<T>::push(const T *samples, std::size_t n)
+{
+    if (n == 0)
+    {
+        return;
+    }
+
+    // the marker goes first, the worker may publish the samples before this call returns
+    std::uint64_t pushed = m_samples_in.load(std::memory_order_relaxed) + n;
+    m_markers.push(marker{pushed, now()});
+
+    std::size_t accepted = 0;
+    int polls = 0;
+    while (true)
+    {
+        accepted += m_input.push(samples + accepted, n - accepted);
+        if (accepted == n)
+        {
+            break;
+        }
+        m_producer_waits.fetch_add(1, std::memory_order_relaxed);
+        back_off(polls);
+    }
+    m_samples_in.store(pushed, std::memory_order_relaxed);
+}
+
+template <typename T>
+std::size_t basic_stream_stage<T>::pop(T *out, std::size_t n)
+{
+    return m_output.pop(out, n);
+}
+
+template <typename T>
+void basic_stream_stage<T>::flush()
+{
+    int polls = 0;
+    while (m_samples_out.load(std::memory_order_acquire) < m_samples_in.load(std::memory_order_relaxed))
+    {
+        back_off(polls);
+    }
+}
+
+template <typename T>
+stream_statistics basic_stream_stage<T>::get_statistics() const
+{
+    stream_statistics statistics;
+    statistics.samples_out = m_samples_out.load(std::memory_order_acquire);
+    statistics.samples_in = m_samples_in.load(std::memory_order_relaxed);
+    statistics.samples_rejected = m_samples_rejected.load(std::memory_order_relaxed);
+    statistics.producer_waits = m_producer_waits.load(std::memory_order_relaxed);
+    statistics.worker_waits = m_worker_waits.load(std::memory_order_relaxed);
+    statistics.batches = m_batches.load(std::memory_order_relaxed);
+    std::uint64_t count = m_latency_count.load(std::memory_order_relaxed);
+    if (count > 0)
+    {
+        statistics.mean_latency = 1.0e-9 * static_cast<double>(m_latency_sum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+    }
+    statistics.max_latency = 1.0e-9 * static_cast<double>(m_latency_max.load(std::memory_order_relaxed));
+    return statistics;
+}
+
+template class basic_stream_stage<double>;
+template class basic_stream_stage<float>;
@@ -0,0 +1,127 @@
+#ifndef __STREAM_STAGE__H__
+#define __STREAM_STAGE__H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "butterworth.h"
+#include "spsc_ring.h"
+
+/** Counters of a stream_stage (see basic_stream_stage::get_statistics). */
+struct stream_statistics
+{
+    std::uint64_t samples_in = 0;       // samples accepted from the producer
+    std::uint64_t samples_out = 0;      // filtered samples published to the output ring
+    std::uint64_t samples_rejected = 0; // samples try_push could not accept (input ring full)
+    std::uint64_t producer_waits = 0;   // times push waited for space in the input ring
+    std::uint64_t worker_waits = 0;     // times the worker waited for space in the output ring
+    std::uint64_t batches = 0;          // blocks processed by the worker
+    double mean_latency = 0;            // mean time from push to publication of the last sample of a push (seconds)
+    double max_latency = 0;             // maximum of that time (seconds)
+};
+
+/** Streaming stage: a producer thread pushes samples, a worker thread filters them in blocks and publishes the
+ * output for a consumer thread.
+ *
+ * @tparam T sample type (explicitly instantiated for float and double)
+ *
+ * Producer and worker are connected by a lock-free single-producer/single-consumer ring, the worker and the
+ * consumer by a second one, so there are no locks and no per-sample handoff in the data path. The worker
+ * drains the input ring in batches of up to batch_size samples and processes them with the block path of the
+ * filter. When the consumer falls behind, the output ring fills up, the worker waits and the input ring fills
+ * up in turn (back-pressure): try_push accepts fewer samples, push waits.
+ *
+ * One thread may push, one (possibly the same) thread may pop.
+ */
+template <typename T>
+class basic_stream_stage
+{
+private:
+    struct marker
+    {
+        std::uint64_t end; // number of samples pushed including this push
+        std::int64_t time; // time of the push (steady clock, nanoseconds)
+    };
+
+    basic_butterworth<T> m_filter;
+    std::size_t m_batch_size;
+    spsc_ring<T> m_input;
+    spsc_ring<T> m_output;
+    spsc_ring<marker> m_markers; // push times for the latency counters (skipped when full)
+
+    std::atomic<bool> m_stop{false};
+    std::atomic<std::uint64_t> m_samples_in{0}; // written by the producer only
+    std::atomic<std::uint64_t> m_samples_out{0};
+    std::atomic<std::uint64_t> m_samples_rejected{0};
+    std::atomic<std::uint64_t> m_producer_waits{0};
+    std::atomic<std::uint64_t> m_worker_waits{0};
+    std::atomic<std::uint64_t> m_batches{0};
+    std::atomic<std::uint64_t> m_latency_count{0};
+    std::atomic<std::int64_t> m_latency_sum{0}; // nanoseconds
+    std::atomic<std::int64_t> m_latency_max{0}; // nanoseconds
+    std::thread m_worker;
+
+    void work();
+
+public:
+    /** Start the worker thread.
+     *
+     * @param filter filter applied to the stream (copied, including its state)
+     * @param capacity minimum number of samples in each of the rings (rounded up to a power of two)
+     * @param batch_size maximum number of samples processed at once by the worker (throws std::invalid_argument if 0)
+     */
+    explicit basic_stream_stage(const basic_butterworth<T> &filter, std::size_t capacity = 1 << 16, std::size_t batch_size = 256);
+
+    /** Stop and join the worker thread (samples not yet processed are dropped). */
+    ~basic_stream_stage();
+
+    basic_stream_stage(const basic_stream_stage &) = delete;
+    basic_stream_stage &operator=(const basic_stream_stage &) = delete;
+
+    /** Push samples without waiting (producer only).
+     *
+     * @param samples input samples
+     * @param n number of samples
+     * @return number of samples accepted (less than n if the input ring is full)
+     */
+    std::size_t try_push(const T *samples, std::size_t n);
+
+    /** Push samples, waiting for space in the input ring (producer only).
+     *
+     * @param samples input samples
+     * @param n number of samples
+     */
+    void push(const T *samples, std::size_t n);
+
+    /** Take filtered samples without waiting (consumer only).
+     *
+     * @param out output buffer
+     * @param n maximum number of samples
+     * @return number of samples written to out
+     */
+    std::size_t pop(T *out, std::size_t n);
+
+    /** Get number of filtered samples ready to be popped
+     *
+     * @return number of samples
+     */
+    std::size_t get_available() const { return m_output.get_size(); }
+
+    /** Wait until the worker has published all pushed samples (producer only). The consumer has to keep
+     * popping, otherwise a full output ring stops the worker.
+     */
+    void flush();
+
+    /** Get the counters of the stage
+     *
+     * @return snapshot of the counters
+     */
+    stream_statistics get_statistics() const;
+};
+
+// double precision samples
+using stream_stage = basic_stream_stage<double>;
+
+#endif //!__STREAM_STAGE__H__
@@ -0,0 +1,106 @@
+#include <vector>
+#include <cmath>
+#include <thread>
+
+#include "butterworth.h"
+#include "stream_stage.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+    std::vector<double> test_signal(std::size_t n_samples)
+    {
+        std::vector<double> signal;
+        for (std::size_t i = 0; i < n_samples; i++)
+        {
+            signal.push_back(std::sin(0.05 * i) + 0.5 * std::sin(1.3 * i));
+        }
+        return signal;
+    }
+}
+
+TEST(stream_stage_test, process)
+{
+    const double EPSILON = 1.0e-12;
+
+    std::vector<double> signal(test_signal(100000));
+    butterworth filter{8, std::vector<double>{10, 20}, filter_design::filter_type::bandpass, 50};
+    std::vector<double> expected(butterworth(filter).process(signal));
+
+    // small rings, so producer and worker both have to wait
+    stream_stage stage(filter, 512, 64);
+    std::thread producer([&stage, &signal]()
+                         {
+                             for (std::size_t start = 0, block = 1; start < signal.size(); start += block, block = block % 700 + 37)
+                             {
+                                 stage.push(signal.data() + start, std::min(block, signal.size() - start));
+                             } });
+
+    std::vector<double> result(signal.size());
+    std::size_t n = 0;
+    while (n < result.size())
+    {
+        std::size_t count = stage.pop(result.data() + n, std::min<std::size_t>(100, result.size() - n));
+        if (count == 0)
+        {
+            std::this_thread::yield();
+        }
+        n += count;
+    }
+    producer.join();
+    stage.flush();
+
+    for (std::size_t i = 0; i < signal.size(); i++)
+    {
+        EXPECT_NEAR(expected[i], result[i], EPSILON);
+    }
+
+    stream_statistics statistics(stage.get_statistics());
+    EXPECT_EQ(signal.size(), statistics.samples_in);
+    EXPECT_EQ(signal.size(), statistics.samples_out);
+    EXPECT_EQ(0u, statistics.samples_rejected);
+    EXPECT_GE(statistics.batches, signal.size() / 64);
+    EXPECT_GT(statistics.mean_latency, 0.0);
+    EXPECT_GE(statistics.max_latency, statistics.mean_latency);
+    EXPECT_EQ(0u, stage.get_available());
+}
+
+TEST(stream_stage_test, back_pressure)
+{
+    std::vector<double> signal(test_signal(1000));
+    butterworth filter{4, std::vector<double>{10}, filter_design::filter_type::lowpass, 50};
+    basic_stream_stage<double> stage(filter, 64, 16);
+
+    // nobody pops: the output ring and then the input ring fill up
+    std::size_t accepted = 0;
+    for (int i = 0; i < 1000 && accepted < signal.size(); i++)
+    {
+        accepted += stage.try_push(signal.data() + accepted, signal.size() - accepted);
+        std::this_thread::yield();
+    }
+    EXPECT_LE(accepted, 64u + 64u + 16u);
+    stream_statistics statistics(stage.get_statistics());
+    EXPECT_EQ(accepted, statistics.samples_in);
+    EXPECT_GT(statistics.samples_rejected, 0u);
+
+    // draining continues the stream without gaps
+    std::vector<double> expected(filter.process(std::vector<double>(signal.begin(), signal.begin() + accepted)));
+    std::vector<double> result(accepted);
+    std::size_t n = 0;
+    while (n < accepted)
+    {
+        std::size_t count = stage.pop(result.data() + n, accepted - n);
+        if (count == 0)
+        {
+            std::this_thread::yield();
+        }
+        n += count;
+    }
+    for (std::size_t i = 0; i < accepted; i++)
+    {
+        EXPECT_NEAR(expected[i], result[i], 1.0e-12);
+    }
+
+    EXPECT_THROW(stream_stage(filter, 64, 0), std::invalid_argument);
+}
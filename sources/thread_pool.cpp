@@ -0,0 +1,132 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+thread_pool::thread_pool(std::size_t n_threads)
+    : m_n_threads(n_threads != 0 ? n_threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    for (std::size_t i = 1; i < m_n_threads; i++)
+    {
+        m_workers.emplace_back(&thread_pool::work, this);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_job_ready.notify_all();
+    for (std::thread &worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void thread_pool::run_tasks()
+{
+    // tasks are claimed one by one, so uneven tasks are balanced between the threads
+    for (std::size_t i = m_next_task++; i < m_n_tasks; i = m_next_task++)
+    {
+        try
+        {
+            (*m_task)(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception)
+            {
+                m_exception = std::current_exception();
+            }
+        }
+    }
+}
+
+void thread_pool::work()
+{
+    std::size_t generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_ready.wait(lock, [this, generation]
+                             { return m_stop || m_generation != generation; });
+            if (m_stop)
+            {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        run_tasks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy_workers--;
+        }
+        m_job_done.notify_one();
+    }
+}
+
+void thread_pool::run(std::size_t n_tasks, const std::function<void(std::size_t)> &task)
+{
+    if (n_tasks == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    if (m_workers.empty() || n_tasks == 1)
+    {
+        // like the workers: run all tasks and keep the first exception
+        std::exception_ptr exception;
+        for (std::size_t i = 0; i < n_tasks; i++)
+        {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+            }
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_n_tasks = n_tasks;
+        m_next_task = 0;
+        m_busy_workers = m_workers.size();
+        m_exception = nullptr;
+        m_generation++;
+    }
+    m_job_ready.notify_all();
+
+    run_tasks();
+
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_job_done.wait(lock, [this]
+                        { return m_busy_workers == 0; });
+        m_task = nullptr;
+        exception = m_exception;
+        m_exception = nullptr;
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef __THREAD_POOL__H__
+#define __THREAD_POOL__H__
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Fixed set of worker threads that run indexed tasks in parallel.
+ *
+ * The thread calling run takes part in the work, so a pool of n threads starts n - 1 workers.
+ * Calls to run from different threads are serialized.
+ */
+class thread_pool
+{
+private:
+    std::size_t m_n_threads;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_run_mutex; // serializes calls to run
+    std::mutex m_mutex;     // guards the job below
+    std::condition_variable m_job_ready;
+    std::condition_variable m_job_done;
+    std::size_t m_generation = 0; // incremented for every job
+    bool m_stop = false;
+
+    const std::function<void(std::size_t)> *m_task = nullptr;
+    std::size_t m_n_tasks = 0;
+    std::atomic<std::size_t> m_next_task{0};
+    std::size_t m_busy_workers = 0;
+    std::exception_ptr m_exception;
+
+    void work();
+    void run_tasks();
+
+public:
+    /** Start the worker threads.
+     *
+     * @param n_threads number of threads working on a job, including the caller of run
+     *                  (0 selects the number of hardware threads)
+     */
+    explicit thread_pool(std::size_t n_threads = 0);
+
+    /** Stop and join the worker threads. */
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    /** Get number of threads working on a job (including the caller of run)
+     *
+     * @return number of threads
+     */
+    std::size_t get_threads() const { return m_n_threads; }
+
+    /** Run task(i) for every i in [0, n_tasks) and wait until all tasks are finished.
+     *
+     * The first exception thrown by a task is rethrown after all tasks are finished.
+     *
+     * @param n_tasks number of tasks
+     * @param task function called with the task index
+     */
+    void run(std::size_t n_tasks, const std::function<void(std::size_t)> &task);
+};
+
+#endif //!__THREAD_POOL__H__
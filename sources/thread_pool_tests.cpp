@@ -0,0 +1,52 @@
+#include <vector>
+#include <atomic>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+#include "gtest/gtest.h"
+
+TEST(thread_pool_test, run)
+{
+    for (std::size_t n_threads : {1, 2, 4})
+    {
+        thread_pool pool(n_threads);
+        EXPECT_EQ(n_threads, pool.get_threads());
+
+        // every task runs exactly once, also for repeated jobs and more tasks than threads
+        for (std::size_t n_tasks : {0, 1, 3, 100})
+        {
+            std::vector<std::atomic<int>> counts(n_tasks);
+            pool.run(n_tasks, [&counts](std::size_t i)
+                     { counts[i]++; });
+            for (std::size_t i = 0; i < n_tasks; i++)
+            {
+                EXPECT_EQ(1, counts[i]);
+            }
+        }
+    }
+    EXPECT_LE(1u, thread_pool().get_threads());
+}
+
+TEST(thread_pool_test, exception)
+{
+    // one thread runs the tasks serially on the calling thread
+    for (std::size_t n_threads : {1, 3})
+    {
+        thread_pool pool(n_threads);
+        std::atomic<int> count{0};
+        EXPECT_THROW(pool.run(10, [&count](std::size_t i)
+                              {
+                                  count++;
+                                  if (i == 5)
+                                  {
+                                      throw std::invalid_argument("task failed");
+                                  } }),
+                     std::invalid_argument);
+        // the remaining tasks are finished and the pool is still usable
+        EXPECT_EQ(10, count);
+        pool.run(4, [&count](std::size_t)
+                 { count++; });
+        EXPECT_EQ(14, count);
+    }
+}
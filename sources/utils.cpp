@@ -1,8 +1,82 @@
 #include "utils.h"
 #include <exception>
 #include <algorithm>
+#include <iostream>
 #include <assert.h>
 
+namespace
+{
+    std::atomic<utils::log_sink> active_sink{&utils::standard_log_sink};
+
+    // the stream of a thread is reused for its messages, so formatting does not allocate a new stream or text
+    thread_local utils::detail::log_stream thread_stream;
+    thread_local bool thread_stream_used = false;
+} // namespace
+
+std::atomic<utils::log_level> utils::detail::log_threshold{static_cast<utils::log_level>(FILTERLIB_LOG_LEVEL)};
+
+void utils::set_log_sink(log_sink sink)
+{
+    active_sink.store(sink != nullptr ? sink : &standard_log_sink);
+}
+
+void utils::standard_log_sink(log_level level, const std::string &message)
+{
+    const char *prefix = "";
+    switch (level)
+    {
+    case log_level::debug:
+        prefix = "Debug: ";
+        break;
+    case log_level::info:
+        prefix = "Info: ";
+        break;
+    case log_level::warning:
+        prefix = "Warning: ";
+        break;
+    case log_level::error:
+        prefix = "Error: ";
+        break;
+    case log_level::off:
+        break;
+    }
+    // one write per line so lines of different threads do not interleave, no flush
+    std::string line(prefix);
+    line += message;
+    line += '\n';
+    std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+utils::log_record::log_record(log_level level) : m_level(level), m_stream(&thread_stream)
+{
+    if (thread_stream_used)
+    {
+        m_nested = std::make_unique<detail::log_stream>();
+        m_stream = m_nested.get();
+        return;
+    }
+    thread_stream_used = true;
+    // keeps the capacity of the previous messages, so formatting does not allocate once it fits
+    thread_stream.buffer.clear();
+    thread_stream.stream.clear();
+}
+
+utils::log_record::~log_record()
+{
+    try
+    {
+        active_sink.load()(m_level, m_stream->buffer.text());
+    }
+    catch (...)
+    {
+        // a failing sink must not throw out of a log statement
+    }
+    if (!m_nested)
+    {
+        thread_stream_used = false;
+    }
+}
+
 std::complex<double> utils::pop_nearest_real_complex(std::vector<std::complex<double>> &fro, std::complex<double> to, bool real)
 {
     sort(fro.begin(), fro.end(), [to](std::complex<double> f1, std::complex<double> f2) -> double
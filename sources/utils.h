@@ -1,8 +1,10 @@
 #ifndef __UTILS__H__
 #define __UTILS__H__
 
-#include <iostream>
-#include <sstream>
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
 #include <vector>
 #include <complex>
@@ -10,42 +12,158 @@
 
 const double PI = 3.141592653589793238463;
 
-#define DEBUG
+// log levels for FILTERLIB_LOG_LEVEL (values of utils::log_level)
+#define FILTERLIB_LOG_LEVEL_DEBUG 0
+#define FILTERLIB_LOG_LEVEL_INFO 1
+#define FILTERLIB_LOG_LEVEL_WARNING 2
+#define FILTERLIB_LOG_LEVEL_ERROR 3
+#define FILTERLIB_LOG_LEVEL_OFF 4
 
+// lowest level compiled in, the statements of lower levels are removed by the compiler
+#ifndef FILTERLIB_LOG_LEVEL
 #ifdef DEBUG
-#define DEBUG_STREAM(stream)                             \
-    {                                                    \
-        std::stringstream ss;                            \
-        ss << stream;                                    \
-        std::cout << "Debug: " << ss.str() << std::endl; \
-    }
+#define FILTERLIB_LOG_LEVEL FILTERLIB_LOG_LEVEL_DEBUG
 #else
-#define DEBUG_STREAM(stream)
+#define FILTERLIB_LOG_LEVEL FILTERLIB_LOG_LEVEL_INFO
 #endif //DEBUG
+#endif //FILTERLIB_LOG_LEVEL
 
-#define INFO_STREAM(stream)                             \
-    {                                                   \
-        std::stringstream ss;                           \
-        ss << stream;                                   \
-        std::cout << "Info: " << ss.str() << std::endl; \
-    }
+/** Log a message built with operator<< (e.g. `INFO_STREAM("order " << order)`).
+ *
+ * Below FILTERLIB_LOG_LEVEL the statement compiles to nothing. Otherwise the message is only formatted if
+ * the level is enabled at runtime (utils::set_log_level), so disabled statements cost one relaxed load.
+ * The message goes to the sink set with utils::set_log_sink.
+ */
+#define FILTERLIB_LOG(level, message)                                                        \
+    do                                                                                       \
+    {                                                                                        \
+        if (static_cast<int>(level) >= FILTERLIB_LOG_LEVEL && utils::log_enabled(level))     \
+        {                                                                                    \
+            utils::log_record filterlib_log_record(level);                                   \
+            filterlib_log_record.stream() << message;                                        \
+        }                                                                                    \
+    } while (false)
 
-#define WARN_STREAM(stream)                                \
-    {                                                      \
-        std::stringstream ss;                              \
-        ss << stream;                                      \
-        std::cout << "Warning: " << ss.str() << std::endl; \
-    }
-
-#define ERROR_STREAM(stream)                             \
-    {                                                    \
-        std::stringstream ss;                            \
-        ss << stream;                                    \
-        std::cout << "Error: " << ss.str() << std::endl; \
-    }
+#define DEBUG_STREAM(message) FILTERLIB_LOG(utils::log_level::debug, message)
+#define INFO_STREAM(message) FILTERLIB_LOG(utils::log_level::info, message)
+#define WARN_STREAM(message) FILTERLIB_LOG(utils::log_level::warning, message)
+#define ERROR_STREAM(message) FILTERLIB_LOG(utils::log_level::error, message)
 
 namespace utils
 {
+    /** Severity of a log message. */
+    enum class log_level
+    {
+        debug = FILTERLIB_LOG_LEVEL_DEBUG,
+        info = FILTERLIB_LOG_LEVEL_INFO,
+        warning = FILTERLIB_LOG_LEVEL_WARNING,
+        error = FILTERLIB_LOG_LEVEL_ERROR,
+        off = FILTERLIB_LOG_LEVEL_OFF
+    };
+
+    /** Receives formatted log messages (without prefix and line break), may be called from any thread. */
+    using log_sink = void (*)(log_level level, const std::string &message);
+
+    namespace detail
+    {
+        // defined in utils.cpp (one threshold for all translation units, whatever their FILTERLIB_LOG_LEVEL)
+        extern std::atomic<log_level> log_threshold;
+
+        /** Stream buffer that appends to a string, cleared without releasing the capacity of the string. */
+        class log_buffer : public std::streambuf
+        {
+        private:
+            std::string m_text;
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    m_text.push_back(traits_type::to_char_type(c));
+                }
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char *s, std::streamsize n) override
+            {
+                m_text.append(s, static_cast<std::size_t>(n));
+                return n;
+            }
+
+        public:
+            const std::string &text() const { return m_text; }
+            void clear() { m_text.clear(); }
+        };
+
+        /** Output stream formatting into a log_buffer. */
+        struct log_stream
+        {
+            log_buffer buffer;
+            std::ostream stream{&buffer};
+        };
+    } // namespace detail
+
+    /** Test whether messages of a level are passed to the sink (levels below FILTERLIB_LOG_LEVEL are never).
+     *
+     * @param level level of the message
+     * @return true if enabled
+     */
+    inline bool log_enabled(log_level level)
+    {
+        return level != log_level::off && level >= detail::log_threshold.load(std::memory_order_relaxed);
+    }
+
+    /** Set the lowest level passed to the sink at runtime (default FILTERLIB_LOG_LEVEL of the library build).
+     *
+     * @param level lowest enabled level, log_level::off disables logging
+     */
+    inline void set_log_level(log_level level) { detail::log_threshold.store(level, std::memory_order_relaxed); }
+
+    /** Get the lowest level passed to the sink
+     *
+     * @return lowest enabled level
+     */
+    inline log_level get_log_level() { return detail::log_threshold.load(std::memory_order_relaxed); }
+
+    /** Set the receiver of the log messages.
+     *
+     * @param sink function called with every message, nullptr restores the default (standard_log_sink)
+     */
+    void set_log_sink(log_sink sink);
+
+    /** Default sink: writes "Debug: ", "Info: ", "Warning: " or "Error: " and the message as one line to the
+     * standard output (buffered, without flushing).
+     *
+     * @param level level of the message
+     * @param message message
+     */
+    void standard_log_sink(log_level level, const std::string &message);
+
+    /** One log message, formatted into a stream reused by the thread and passed to the sink on destruction
+     * (used by the log macros).
+     */
+    class log_record
+    {
+    private:
+        log_level m_level;
+        detail::log_stream *m_stream;
+        std::unique_ptr<detail::log_stream> m_nested; // stream of a record built while formatting another
+
+    public:
+        explicit log_record(log_level level);
+        ~log_record();
+
+        log_record(const log_record &) = delete;
+        log_record &operator=(const log_record &) = delete;
+
+        /** Get the stream the message is formatted into
+         *
+         * @return stream
+         */
+        std::ostream &stream() { return m_stream->stream; }
+    };
+
     /** Test whether z is real or has a complex part.
      *
      * @param z number with or without complex part
@@ -49,3 +49,70 @@ TEST(utils_tests, pop_nearest_real_complex)
     EXPECT_NEAR(std::real(a3), 0.2, EPSILON);
     EXPECT_NEAR(std::imag(a3), 0.0, EPSILON);
 }
+
+namespace
+{
+    std::vector<std::pair<utils::log_level, std::string>> captured;
+
+    void capture(utils::log_level level, const std::string &message)
+    {
+        captured.emplace_back(level, message);
+    }
+
+    struct nested_message
+    {
+    };
+
+    std::ostream &operator<<(std::ostream &stream, const nested_message &)
+    {
+        WARN_STREAM("inner");
+        return stream << "outer";
+    }
+}
+
+TEST(utils_tests, logging)
+{
+    if (FILTERLIB_LOG_LEVEL > FILTERLIB_LOG_LEVEL_INFO)
+    {
+        GTEST_SKIP() << "info messages are compiled out";
+    }
+    captured.clear();
+    utils::set_log_sink(&capture);
+    utils::log_level level = utils::get_log_level();
+    utils::set_log_level(utils::log_level::info);
+
+    int formatted = 0;
+    INFO_STREAM("order " << 4 << " (" << ++formatted << ")");
+    ERROR_STREAM("error");
+    ASSERT_EQ(2u, captured.size());
+    EXPECT_EQ(utils::log_level::info, captured[0].first);
+    EXPECT_EQ("order 4 (1)", captured[0].second);
+    EXPECT_EQ(utils::log_level::error, captured[1].first);
+    EXPECT_EQ("error", captured[1].second); // the reused text of the thread starts empty
+
+    // disabled at runtime: not formatted
+    utils::set_log_level(utils::log_level::warning);
+    INFO_STREAM(++formatted);
+    EXPECT_EQ(1, formatted);
+    EXPECT_FALSE(utils::log_enabled(utils::log_level::info));
+    EXPECT_TRUE(utils::log_enabled(utils::log_level::warning));
+
+    // below the compiled level: removed, even if enabled at runtime
+    utils::set_log_level(utils::log_level::debug);
+    DEBUG_STREAM(++formatted);
+    EXPECT_EQ(FILTERLIB_LOG_LEVEL <= FILTERLIB_LOG_LEVEL_DEBUG ? 2 : 1, formatted);
+
+    // a message logged while another one is formatted
+    captured.clear();
+    WARN_STREAM("before " << nested_message() << " after");
+    ASSERT_EQ(2u, captured.size());
+    EXPECT_EQ("inner", captured[0].second);
+    EXPECT_EQ("before outer after", captured[1].second);
+
+    utils::set_log_level(utils::log_level::off);
+    ERROR_STREAM("off");
+    EXPECT_EQ(2u, captured.size());
+
+    utils::set_log_sink(nullptr);
+    utils::set_log_level(level);
+}
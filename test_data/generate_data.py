@@ -41,6 +41,9 @@ if __name__ == "__main__":
     print(signal.zpk2sos(z=np.array(
         [-1, -0.5-0.5j, -0.5+0.5j]), p=np.array([0.75, 0.8+0.1j, 0.8-0.1j]), k=1.0))
 
+    print(30*"-", "filter_design_test.zpk2sos_pairing", 30*"-")
+    print(signal.butter(5, [0.3, 4.0], 'bs', fs=50, output='sos'))
+
     print(30*"-", "butterworth_test.lowpass", 30*"-")
     print(signal.butter(8, 15, 'lp', fs=50, output='sos'))
 
@@ -56,3 +59,17 @@ if __name__ == "__main__":
     print(30*"-", "butterworth_test.process", 30*"-")
     sos = signal.butter(4, [15, 20], 'bs', fs=50, output='sos')
     print(signal.sosfilt(sos, np.array([1, 3, 2, 4, 3])))
+
+    print(30*"-", "butterworth_test.filtfilt", 30*"-")
+    x = np.array([1, 3, 2, 4, 3, 5, 4, 2, 1, 0, -1, -3, -2, 0, 1, 2, 4, 3, 2, 1])
+    sos = signal.butter(4, 10, 'lp', fs=50, output='sos')
+    print(signal.sosfiltfilt(sos, x))
+    sos = signal.butter(2, [10, 20], 'bp', fs=50, output='sos')
+    print(signal.sosfiltfilt(sos, x))
+
+    print(30*"-", "butterworth_test.steady_state", 30*"-")
+    sos = signal.butter(4, 10, 'lp', fs=50, output='sos')
+    zi = signal.sosfilt_zi(sos)
+    print(zi)
+    x = np.array([2, 2.5, 3, 3.5, 4])
+    print(signal.sosfilt(sos, x, zi=zi * x[0])[0])
@@ -4,9 +4,9 @@ import numpy as np
 import matplotlib.pyplot as plt
 
 if __name__ == "__main__":
-    original = np.loadtxt("bin/original.txt")
-    process_batch = np.loadtxt("bin/process_batch.txt")
-    process_sample = np.loadtxt("bin/process_sample.txt")
+    original = np.load("bin/original.npy")
+    process_batch = np.load("bin/process_batch.npy")
+    process_sample = np.load("bin/process_sample.npy")
 
     fig, axs = plt.subplots(3, figsize=(10, 10))
     fig.suptitle('example application output')